@@ -0,0 +1,378 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "PendulumEquations.h"
+#include "PendulumEnsemble.h"
+#include "Solver.h"
+#include "SolverTaylor.h"
+
+#include "DoubleDouble.h"
+#include "WorkPrecision.h"
+
+// Work-precision sweep of the integrators of the pendulum model.
+// Every method runs in float, double and mixed precision (double state, float derivates)
+// over a sweep of step sizes or tolerances on a fixed set of initial conditions,
+// errors are measured at the end of the interval against a double-double Taylor reference (about 32 digits,
+// long double is no wider than double with MSVC). Afterwards the ensemble throughput of every precision is reported.
+//
+// Usage: Benchmark [--csv file] [--svg file] [--accuracy error]
+
+struct InitialConditions
+{
+    std::string name;
+    double mass[2];
+    double l[2];
+    double theta[2];
+    double w[2];
+};
+
+static const double interval = 5.0;
+// Each point is repeated until at least this much wall time is measured
+static const double min_measured_seconds = 0.05;
+
+static const double pi = PendulumConstants<double>::pi;
+
+template<typename T, typename E> struct PrecisionName { static const char* get() { return "mixed"; } };
+template<> struct PrecisionName<float, float> { static const char* get() { return "float"; } };
+template<> struct PrecisionName<double, double> { static const char* get() { return "double"; } };
+
+double angle_error(double a, double b)
+{
+    double d = fmod(a - b, 2 * pi);
+    if (d > pi)
+        d -= 2 * pi;
+    if (d < -pi)
+        d += 2 * pi;
+
+    return fabs(d);
+}
+
+double state_error(const DoubleDouble* reference, const double* y)
+{
+    double error = 0.0;
+    for (int i = 0; i < 4; ++i)
+    {
+        // The difference is taken in double-double, y itself is exact there
+        const double d = (double)(reference[i] - y[i]);
+        double e = i % 2 == 0 ? angle_error(d, 0.0) : fabs(d);
+        error = fmax(error, e);
+    }
+
+    return error;
+}
+
+// Taylor series of a fixed high order in double-double with the step from the decay of the last coefficients
+// as in SolverTaylor, the step lands exactly on the end of the interval
+void calculate_reference(const InitialConditions& c, double time, DoubleDouble* y_out)
+{
+    const unsigned int order = 30;
+    const unsigned int tail = 4;
+    const double tolerance = 1e-30;
+
+    const DoubleDouble m1 = c.mass[0], l1 = c.l[0], m2 = c.mass[1], l2 = c.l[1];
+
+    DoubleDouble y[4] = { c.theta[0], c.w[0], c.theta[1], c.w[1] };
+    DoubleDouble coeffs[4 * (order + 1)];
+
+    DoubleDouble elapsed = 0.0;
+    bool last = false;
+    while (!last)
+    {
+        pendulum_taylor_coefficients<DoubleDouble>(y, order, coeffs, m1, l1, m2, l2);
+
+        // The step needs no extra precision, only its sum does
+        double norm_y = 0.0;
+        double norm[tail] = {};
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            norm_y = fmax(norm_y, fabs(y[i].hi));
+            for (unsigned int j = 0; j < tail; ++j)
+                norm[j] = fmax(norm[j], fabs(coeffs[i * (order + 1) + order - j].hi));
+        }
+
+        const double eps = tolerance * fmax(norm_y, 1.0);
+        double step = HUGE_VAL;
+        for (unsigned int j = 0; j < tail; ++j)
+        {
+            if (norm[j] > 0)
+                step = fmin(step, pow(eps / norm[j], 1.0 / (order - j)));
+        }
+        step *= exp(-0.7 / (order - 1));
+
+        DoubleDouble h = step;
+        const DoubleDouble remaining = DoubleDouble(time) - elapsed;
+        if (step >= remaining.hi)
+        {
+            h = remaining;
+            last = true;
+        }
+
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            const DoubleDouble* coeff = coeffs + i * (order + 1);
+
+            DoubleDouble value = coeff[order];
+            for (unsigned int k = order; k-- > 0;)
+                value = value * h + coeff[k];
+
+            y[i] = value;
+        }
+
+        elapsed += h;
+    }
+
+    for (int i = 0; i < 4; ++i)
+        y_out[i] = y[i];
+}
+
+// Runs one integration of the whole interval and returns the final state
+template<typename T, typename E>
+void integrate(const InitialConditions& c, SolverMethods::Method method, double setting, double* y_out, unsigned long long& evaluations)
+{
+    const T m1 = (T)c.mass[0], l1 = (T)c.l[0], m2 = (T)c.mass[1], l2 = (T)c.l[1];
+
+    T y[4] = { (T)c.theta[0], (T)c.w[0], (T)c.theta[1], (T)c.w[1] };
+    T y_end[4] = {};
+
+    if (method == SolverMethods::Taylor)
+    {
+        typename SolverTaylor<T>::Coefficients func = [=](const T* y_in, unsigned int order, T* coeffs)
+        {
+            pendulum_taylor_coefficients<T>(y_in, order, coeffs, m1, l1, m2, l2);
+        };
+
+        SolverTaylor<T> solver;
+        solver.setTolerance((T)setting);
+        solver.SolveTaylor(y, func, y_end, 4, (T)interval);
+
+        // One recursion yields order + 1 coefficients, each about the work of a derivative call of the RK methods
+        evaluations = solver.countEvaluations() * (solver.selectOrder() + 1);
+    }
+    else
+    {
+        const E e_m1 = (E)m1, e_l1 = (E)l1, e_m2 = (E)m2, e_l2 = (E)l2;
+
+        typename BasicSolverODEs<T, E>::Derivates func = [=](const E* y_in, E* derivates)
+        {
+            derivates[0] = y_in[1];
+            derivates[2] = y_in[3];
+            pendulum_accelerations<E>(y_in[0], y_in[1], y_in[2], y_in[3], e_m1, e_l1, e_m2, e_l2, derivates[1], derivates[3]);
+        };
+
+        BasicSolverODEs<T, E> solver;
+        solver.setMethod(method);
+
+        if (method == SolverMethods::RungeKutta45)
+        {
+            solver.setStep((T)interval);
+            solver.setTolerance((T)setting);
+            solver.SolveRK45(y, func, y_end, 4);
+        }
+        else
+        {
+            const int steps = (int)ceil(interval / setting);
+            solver.setStep((T)(interval / steps));
+
+            for (int i = 0; i < steps; ++i)
+            {
+                solver.SolveRK4(y, func, y_end, 4);
+
+                for (int j = 0; j < 4; ++j)
+                    y[j] = y_end[j];
+            }
+        }
+
+        evaluations = solver.countEvaluations();
+    }
+
+    for (int i = 0; i < 4; ++i)
+        y_out[i] = (double)y_end[i];
+}
+
+template<typename T, typename E = T>
+Result run(const std::vector<InitialConditions>& conditions, const std::vector<std::vector<DoubleDouble>>& references,
+           SolverMethods::Method method, double setting)
+{
+    Result result;
+    // No markup characters, the label goes into the SVG and the CSV as is
+    result.method = SolverMethods::getStringMethod(method) + " " + PrecisionName<T, E>::get();
+    result.setting_name = method == SolverMethods::RungeKutta4 ? "step" : "tolerance";
+    result.setting = setting;
+
+    for (size_t i = 0; i < conditions.size(); ++i)
+    {
+        double y[4] = {};
+        unsigned long long evaluations = 0;
+        integrate<T, E>(conditions[i], method, setting, y, evaluations);
+
+        result.error = fmax(result.error, state_error(references[i].data(), y));
+        result.evaluations += evaluations;
+    }
+
+    int repeats = 0;
+    double seconds = 0.0;
+    auto start = std::chrono::steady_clock::now();
+
+    while (seconds < min_measured_seconds)
+    {
+        for (size_t i = 0; i < conditions.size(); ++i)
+        {
+            double y[4] = {};
+            unsigned long long evaluations = 0;
+            integrate<T, E>(conditions[i], method, setting, y, evaluations);
+        }
+
+        ++repeats;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    result.seconds = seconds / repeats;
+
+    return result;
+}
+
+template<typename T, typename E = T>
+void sweep(const std::vector<InitialConditions>& conditions, const std::vector<std::vector<DoubleDouble>>& references,
+           double min_tolerance, std::vector<Result>& results)
+{
+    for (int k = 4; k <= 14; ++k)
+        results.push_back(run<T, E>(conditions, references, SolverMethods::RungeKutta4, 1.0 / (1 << k)));
+
+    for (double tol = 1e-2; tol >= min_tolerance * 0.99; tol /= 10)
+        results.push_back(run<T, E>(conditions, references, SolverMethods::RungeKutta45, tol));
+}
+
+// Pendulum steps per second of an ensemble and its error on a few pendulums against the reference
+template<typename T, typename E = T>
+void run_ensemble(unsigned int count, unsigned int steps, double step)
+{
+    BasicPendulumEnsemble<T, E> ensemble(count);
+    ensemble.setDriftThreshold(0);
+
+    std::vector<InitialConditions> conditions;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        InitialConditions c = { "", { 0.6, 0.6 + 0.3 * i / count }, { 0.4, 0.4 }, { 1.0 + 0.5 * i / count, 1.5 }, { 0.0, 0.0 } };
+        conditions.push_back(c);
+
+        const T mass[2] = { (T)c.mass[0], (T)c.mass[1] }, l[2] = { (T)c.l[0], (T)c.l[1] };
+        const T theta[2] = { (T)c.theta[0], (T)c.theta[1] }, w[2] = { (T)c.w[0], (T)c.w[1] };
+        ensemble.setPendulum(i, mass, l, theta, w);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ensemble.calculatePhysicalModel((T)step, steps);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double error = 0.0;
+    for (unsigned int i = 0; i < count; i += count / 8)
+    {
+        DoubleDouble reference[4];
+        calculate_reference(conditions[i], steps * step, reference);
+
+        T y[4] = {};
+        ensemble.getState(i, y);
+
+        double y_double[4] = { (double)y[0], (double)y[1], (double)y[2], (double)y[3] };
+        error = fmax(error, state_error(reference, y_double));
+    }
+
+    std::cout << std::left << std::setw(14) << PrecisionName<T, E>::get()
+              << std::setw(14) << std::scientific << std::setprecision(3) << count * (double)steps / seconds
+              << std::setw(14) << error << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    const char* csv_file = "work_precision.csv";
+    const char* svg_file = "work_precision.svg";
+    double accuracy = 0.0;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--csv") == 0)
+            csv_file = argv[i + 1];
+        else if (strcmp(argv[i], "--svg") == 0)
+            svg_file = argv[i + 1];
+        else if (strcmp(argv[i], "--accuracy") == 0)
+            accuracy = atof(argv[i + 1]);
+        else
+            std::cout << "Unknown option " << argv[i] << std::endl;
+    }
+
+    std::vector<InitialConditions> conditions = {
+        { "small",    { 0.6, 0.6 }, { 0.4, 0.4 }, { 0.3, -0.2 },       { 0.0, 0.0 } },
+        { "moderate", { 0.6, 0.9 }, { 0.4, 0.7 }, { 1.2, 2.0 },        { 0.3, -0.5 } },
+        { "default",  { 0.6, 0.6 }, { 0.4, 0.4 }, { pi / 2, pi / 2 },  { 0.0, 0.0 } }
+    };
+
+    std::vector<std::vector<DoubleDouble>> references;
+
+    for (auto& c : conditions)
+    {
+        references.emplace_back(4);
+        calculate_reference(c, interval, references.back().data());
+    }
+
+    std::vector<Result> results;
+
+    // Tolerances end at the resolution of the state: float rounds at about 1e-7 relative, so tighter
+    // tolerances are never met and the adaptive methods only fall back to their minimal step
+    sweep<float>(conditions, references, 1e-7, results);
+    sweep<double, float>(conditions, references, 1e-7, results);
+    sweep<double>(conditions, references, 1e-12, results);
+
+    for (int k = 4; k <= 16; k += 2)
+        results.push_back(run<double>(conditions, references, SolverMethods::Taylor, pow(10.0, -k)));
+
+    std::cout << "Interval " << interval << " s, " << conditions.size() << " initial conditions, error is max over all" << std::endl;
+    std::cout << std::left << std::setw(22) << "method" << std::setw(20) << "setting"
+              << std::setw(14) << "error" << std::setw(14) << "time, ms" << std::setw(14) << "derivatives" << std::endl;
+
+    for (auto& r : results)
+    {
+        std::cout << std::left << std::setw(22) << r.method
+                  << std::setw(10) << r.setting_name << std::setw(10) << std::scientific << std::setprecision(2) << r.setting
+                  << std::setw(14) << std::setprecision(3) << r.error
+                  << std::setw(14) << std::fixed << std::setprecision(3) << r.seconds * 1000
+                  << std::setw(14) << r.evaluations << std::endl;
+    }
+
+    if (write_csv(csv_file, results))
+        std::cout << "Results written to " << csv_file << std::endl;
+    if (write_svg(svg_file, results))
+        std::cout << "Work-precision diagram written to " << svg_file << std::endl;
+
+    if (accuracy > 0.0)
+    {
+        const Result* cheapest = find_cheapest(results, accuracy);
+        if (cheapest)
+        {
+            std::cout << "Cheapest for error <= " << std::scientific << accuracy << ": " << cheapest->method << ' '
+                      << cheapest->setting_name << '=' << cheapest->setting << std::endl;
+        }
+        else
+        {
+            std::cout << "No method reaches error <= " << std::scientific << accuracy << std::endl;
+        }
+    }
+
+    const unsigned int ensemble_count = 16384, ensemble_steps = 240;
+    const double ensemble_step = 1.0 / 240;
+
+    std::cout << std::endl << "Ensemble of " << ensemble_count << " pendulums, RK4, " << ensemble_steps
+              << " steps of " << std::fixed << std::setprecision(5) << ensemble_step << " s" << std::endl;
+    std::cout << std::left << std::setw(14) << "precision" << std::setw(14) << "steps/s" << std::setw(14) << "error" << std::endl;
+
+    run_ensemble<float>(ensemble_count, ensemble_steps, ensemble_step);
+    run_ensemble<double, float>(ensemble_count, ensemble_steps, ensemble_step);
+    run_ensemble<double>(ensemble_count, ensemble_steps, ensemble_step);
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cmath>
+#include <type_traits>
+
+// Unevaluated sum hi + lo of two doubles with |lo| <= ulp(hi) / 2: about 32 significant digits on any compiler,
+// unlike long double, which is plain double with MSVC. Only what the Taylor reference of the benchmark needs:
+// arithmetic, sin and cos (Dekker, Knuth; Hida, Li & Bailey, "Library for double-double and quad-double arithmetic").
+struct DoubleDouble
+{
+    double hi;
+    double lo;
+
+    constexpr DoubleDouble() : hi(0.0), lo(0.0) {}
+    constexpr DoubleDouble(double p_hi, double p_lo = 0.0) : hi(p_hi), lo(p_lo) {}
+    constexpr DoubleDouble(long double x) : hi((double)x), lo((double)(x - (long double)(double)x)) {}
+
+    template<typename U, typename std::enable_if<std::is_integral<U>::value, int>::type = 0>
+    constexpr DoubleDouble(U x) : hi((double)x), lo(0.0) {}
+
+    explicit operator double() const { return hi + lo; }
+
+    // s + e == a + b exactly
+    static DoubleDouble twoSum(double a, double b)
+    {
+        const double s = a + b;
+        const double v = s - a;
+        return DoubleDouble(s, (a - (s - v)) + (b - v));
+    }
+
+    // Same for |a| >= |b|
+    static DoubleDouble quickTwoSum(double a, double b)
+    {
+        const double s = a + b;
+        return DoubleDouble(s, b - (s - a));
+    }
+
+    static DoubleDouble twoProduct(double a, double b)
+    {
+        const double p = a * b;
+        return DoubleDouble(p, std::fma(a, b, -p));
+    }
+
+    friend DoubleDouble operator+(DoubleDouble a, DoubleDouble b)
+    {
+        DoubleDouble s = twoSum(a.hi, b.hi);
+        const DoubleDouble t = twoSum(a.lo, b.lo);
+        s.lo += t.hi;
+        s = quickTwoSum(s.hi, s.lo);
+        s.lo += t.lo;
+        return quickTwoSum(s.hi, s.lo);
+    }
+
+    friend DoubleDouble operator-(DoubleDouble a) { return DoubleDouble(-a.hi, -a.lo); }
+    friend DoubleDouble operator-(DoubleDouble a, DoubleDouble b) { return a + (-b); }
+
+    friend DoubleDouble operator*(DoubleDouble a, DoubleDouble b)
+    {
+        DoubleDouble p = twoProduct(a.hi, b.hi);
+        p.lo += a.hi * b.lo + a.lo * b.hi;
+        return quickTwoSum(p.hi, p.lo);
+    }
+
+    friend DoubleDouble operator/(DoubleDouble a, DoubleDouble b)
+    {
+        // Long division, each quotient digit refines the remainder
+        const double q1 = a.hi / b.hi;
+        DoubleDouble r = a - q1 * b;
+        const double q2 = r.hi / b.hi;
+        r = r - q2 * b;
+        const double q3 = r.hi / b.hi;
+
+        return quickTwoSum(q1, q2) + q3;
+    }
+
+    DoubleDouble& operator+=(DoubleDouble b) { return *this = *this + b; }
+    DoubleDouble& operator-=(DoubleDouble b) { return *this = *this - b; }
+    DoubleDouble& operator*=(DoubleDouble b) { return *this = *this * b; }
+    DoubleDouble& operator/=(DoubleDouble b) { return *this = *this / b; }
+
+    friend DoubleDouble sin(DoubleDouble x)
+    {
+        DoubleDouble s, c;
+        sincos(x, s, c);
+        return s;
+    }
+
+    friend DoubleDouble cos(DoubleDouble x)
+    {
+        DoubleDouble s, c;
+        sincos(x, s, c);
+        return c;
+    }
+
+    friend void sincos(DoubleDouble x, DoubleDouble& s, DoubleDouble& c)
+    {
+        const DoubleDouble two_pi(6.283185307179586232, 2.449293598294706414e-16);
+        const DoubleDouble half_pi(1.570796326794896558, 6.123233995736766036e-17);
+
+        // Reduced to |r| <= pi / 4 and the quadrant
+        DoubleDouble r = x - std::nearbyint((double)x / two_pi.hi) * two_pi;
+        const double quadrant = std::nearbyint(r.hi / half_pi.hi);
+        r = r - quadrant * half_pi;
+
+        // Series to below the last digit: the terms of |r| <= 0.79 fall under 1e-33 by the 27th power
+        const DoubleDouble r_sq = r * r;
+        DoubleDouble term = r, sin_r = r, cos_r = 1.0;
+        DoubleDouble cos_term = 1.0;
+        for (int n = 1; n <= 15; ++n)
+        {
+            cos_term = -cos_term * r_sq / DoubleDouble((2 * n - 1) * (2 * n));
+            term = -term * r_sq / DoubleDouble((2 * n) * (2 * n + 1));
+            cos_r += cos_term;
+            sin_r += term;
+        }
+
+        switch (((int)quadrant % 4 + 4) % 4)
+        {
+        case 0: s = sin_r;  c = cos_r;  break;
+        case 1: s = cos_r;  c = -sin_r; break;
+        case 2: s = -sin_r; c = -cos_r; break;
+        default: s = -cos_r; c = sin_r; break;
+        }
+    }
+};
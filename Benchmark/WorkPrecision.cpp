@@ -0,0 +1,172 @@
+#include "WorkPrecision.h"
+
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <math.h>
+
+// Method names and settings end up in element text
+static std::string escape_xml(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '<')
+            escaped += "&lt;";
+        else if (c == '>')
+            escaped += "&gt;";
+        else if (c == '&')
+            escaped += "&amp;";
+        else
+            escaped += c;
+    }
+
+    return escaped;
+}
+
+static const char* colors[] = { "#c0392b", "#2471a3", "#1e8449", "#b9770e", "#7d3c98", "#566573", "#17a589", "#d35400", "#2e4053" };
+
+bool write_csv(const char* filename, const std::vector<Result>& results)
+{
+    std::ofstream out(filename);
+    if (!out)
+    {
+        std::cout << "Failed to open " << filename << std::endl;
+        return false;
+    }
+
+    out << "method,setting_name,setting,error,seconds,derivative_evaluations\n";
+    out << std::setprecision(9);
+
+    for (auto& r : results)
+    {
+        out << r.method << ',' << r.setting_name << ',' << r.setting << ','
+            << r.error << ',' << r.seconds << ',' << r.evaluations << '\n';
+    }
+
+    return true;
+}
+
+bool write_svg(const char* filename, const std::vector<Result>& results)
+{
+    std::ofstream out(filename);
+    if (!out)
+    {
+        std::cout << "Failed to open " << filename << std::endl;
+        return false;
+    }
+
+    // Methods in order of first appearance
+    std::vector<std::string> methods;
+    for (auto& r : results)
+    {
+        bool found = false;
+        for (auto& m : methods)
+            found = found || m == r.method;
+
+        if (!found)
+            methods.push_back(r.method);
+    }
+
+    // Axes in whole decades, errors of exactly zero are clamped to the smallest double
+    double min_x = HUGE_VAL, max_x = -HUGE_VAL, min_y = HUGE_VAL, max_y = -HUGE_VAL;
+    for (auto& r : results)
+    {
+        double x = log10(fmax(r.error, 1e-300));
+        double y = log10(fmax(r.seconds, 1e-300));
+        min_x = fmin(min_x, x); max_x = fmax(max_x, x);
+        min_y = fmin(min_y, y); max_y = fmax(max_y, y);
+    }
+
+    if (results.empty())
+    {
+        min_x = min_y = 0;
+        max_x = max_y = 1;
+    }
+
+    min_x = floor(min_x); max_x = ceil(max_x);
+    min_y = floor(min_y); max_y = ceil(max_y);
+    if (max_x <= min_x) max_x = min_x + 1;
+    if (max_y <= min_y) max_y = min_y + 1;
+
+    const double width = 720, height = 540;
+    const double left = 80, right = 180, top = 30, bottom = 60;
+    const double plot_w = width - left - right, plot_h = height - top - bottom;
+
+    auto px = [&](double x) { return left + (x - min_x) / (max_x - min_x) * plot_w; };
+    auto py = [&](double y) { return top + (max_y - y) / (max_y - min_y) * plot_h; };
+
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+        << "\" font-family=\"sans-serif\" font-size=\"12\">\n";
+    out << "<rect width=\"100%\" height=\"100%\" fill=\"white\"/>\n";
+
+    // Grid and decade labels
+    for (double x = min_x; x <= max_x; x += 1)
+    {
+        out << "<line x1=\"" << px(x) << "\" y1=\"" << top << "\" x2=\"" << px(x) << "\" y2=\"" << top + plot_h
+            << "\" stroke=\"#dddddd\"/>\n";
+        out << "<text x=\"" << px(x) << "\" y=\"" << top + plot_h + 18 << "\" text-anchor=\"middle\">1e"
+            << (int)x << "</text>\n";
+    }
+    for (double y = min_y; y <= max_y; y += 1)
+    {
+        out << "<line x1=\"" << left << "\" y1=\"" << py(y) << "\" x2=\"" << left + plot_w << "\" y2=\"" << py(y)
+            << "\" stroke=\"#dddddd\"/>\n";
+        out << "<text x=\"" << left - 8 << "\" y=\"" << py(y) + 4 << "\" text-anchor=\"end\">1e"
+            << (int)y << "</text>\n";
+    }
+
+    out << "<rect x=\"" << left << "\" y=\"" << top << "\" width=\"" << plot_w << "\" height=\"" << plot_h
+        << "\" fill=\"none\" stroke=\"black\"/>\n";
+    out << "<text x=\"" << left + plot_w / 2 << "\" y=\"" << height - 15 << "\" text-anchor=\"middle\">error</text>\n";
+    out << "<text x=\"20\" y=\"" << top + plot_h / 2 << "\" text-anchor=\"middle\" transform=\"rotate(-90 20 "
+        << top + plot_h / 2 << ")\">wall time, s</text>\n";
+
+    for (size_t m = 0; m < methods.size(); ++m)
+    {
+        const char* color = colors[m % (sizeof(colors) / sizeof(colors[0]))];
+
+        out << "<polyline fill=\"none\" stroke=\"" << color << "\" stroke-width=\"1.5\" points=\"";
+        for (auto& r : results)
+        {
+            if (r.method == methods[m])
+                out << px(log10(fmax(r.error, 1e-300))) << ',' << py(log10(fmax(r.seconds, 1e-300))) << ' ';
+        }
+        out << "\"/>\n";
+
+        for (auto& r : results)
+        {
+            if (r.method != methods[m])
+                continue;
+
+            out << "<circle cx=\"" << px(log10(fmax(r.error, 1e-300))) << "\" cy=\"" << py(log10(fmax(r.seconds, 1e-300)))
+                << "\" r=\"3\" fill=\"" << color << "\"><title>" << escape_xml(r.method) << ' ' << escape_xml(r.setting_name) << '=' << r.setting
+                << ", " << r.evaluations << " derivative evaluations</title></circle>\n";
+        }
+
+        double legend_y = top + 20 + 20 * m;
+        out << "<line x1=\"" << left + plot_w + 15 << "\" y1=\"" << legend_y << "\" x2=\"" << left + plot_w + 40
+            << "\" y2=\"" << legend_y << "\" stroke=\"" << color << "\" stroke-width=\"2\"/>\n";
+        out << "<text x=\"" << left + plot_w + 45 << "\" y=\"" << legend_y + 4 << "\">" << escape_xml(methods[m]) << "</text>\n";
+    }
+
+    out << "<text x=\"" << left + plot_w + 15 << "\" y=\"" << top + plot_h << "\" font-size=\"10\">Evaluations: derivative calls,</text>\n";
+    out << "<text x=\"" << left + plot_w + 15 << "\" y=\"" << top + plot_h + 14 << "\" font-size=\"10\">Taylor order + 1 per step</text>\n";
+
+    out << "</svg>\n";
+
+    return true;
+}
+
+const Result* find_cheapest(const std::vector<Result>& results, double accuracy)
+{
+    const Result* cheapest = nullptr;
+
+    for (auto& r : results)
+    {
+        if (r.error <= accuracy && (!cheapest || r.seconds < cheapest->seconds))
+            cheapest = &r;
+    }
+
+    return cheapest;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// One point of a work-precision diagram
+struct Result
+{
+    std::string method;
+    std::string setting_name;
+    double setting = 0.0;
+    double error = 0.0;
+    double seconds = 0.0;
+    // Derivative evaluations, for Taylor order + 1 per coefficient recursion
+    unsigned long long evaluations = 0;
+};
+
+bool write_csv(const char* filename, const std::vector<Result>& results);
+// Plots log10 of the error against log10 of the wall time, one curve per method
+bool write_svg(const char* filename, const std::vector<Result>& results);
+
+// Cheapest run whose error does not exceed the required accuracy, nullptr if none
+const Result* find_cheapest(const std::vector<Result>& results, double accuracy);
@@ -0,0 +1,338 @@
+#include "PendulumLibrary.h"
+
+#include <new>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cstring>
+
+#include "PendulumEnsemble.h"
+
+// Arrays of the ensemble, in the order of pendulum_ensemble_wrap
+enum EnsembleArray
+{
+    Theta1, Omega1, Theta2, Omega2, Mass1, Length1, Mass2, Length2, NumArrays
+};
+
+struct PendulumEnsembleHandle
+{
+    PendulumScalar scalar = PENDULUM_FLOAT32;
+    unsigned int count = 0;
+
+    // The ensemble is always a view, owned ensembles keep their arrays here
+    std::vector<float> storage_float;
+    std::vector<double> storage_double;
+    void* arrays[NumArrays] = {};
+
+    std::unique_ptr<BasicPendulumEnsemble<float>> ensemble_float;
+    std::unique_ptr<BasicPendulumEnsemble<double>> ensemble_double;
+};
+
+namespace
+{
+    thread_local std::string last_error;
+
+    int fail(int code, const char* message)
+    {
+        last_error = message;
+        return code;
+    }
+
+    template<typename T>
+    BasicPendulumEnsemble<T>* get_ensemble(const PendulumEnsembleHandle* handle);
+
+    template<>
+    BasicPendulumEnsemble<float>* get_ensemble<float>(const PendulumEnsembleHandle* handle) { return handle->ensemble_float.get(); }
+
+    template<>
+    BasicPendulumEnsemble<double>* get_ensemble<double>(const PendulumEnsembleHandle* handle) { return handle->ensemble_double.get(); }
+
+    void store_ensemble(PendulumEnsembleHandle* handle, std::unique_ptr<BasicPendulumEnsemble<float>> ensemble)
+    {
+        handle->ensemble_float = std::move(ensemble);
+    }
+
+    void store_ensemble(PendulumEnsembleHandle* handle, std::unique_ptr<BasicPendulumEnsemble<double>> ensemble)
+    {
+        handle->ensemble_double = std::move(ensemble);
+    }
+
+    template<typename T>
+    void create_ensemble(PendulumEnsembleHandle* handle)
+    {
+        T* a[NumArrays];
+        for (int i = 0; i < NumArrays; ++i)
+            a[i] = static_cast<T*>(handle->arrays[i]);
+
+        std::unique_ptr<BasicPendulumEnsemble<T>> ensemble(new BasicPendulumEnsemble<T>(handle->count,
+            a[Theta1], a[Omega1], a[Theta2], a[Omega2], a[Mass1], a[Length1], a[Mass2], a[Length2]));
+
+        store_ensemble(handle, std::move(ensemble));
+    }
+
+    template<typename T>
+    void copy_in(PendulumEnsembleHandle* handle, int first, const void* const* source, int num)
+    {
+        for (int i = 0; i < num; ++i)
+        {
+            // Wrapped arrays passed back are already in place
+            if (source[i] != nullptr && source[i] != handle->arrays[first + i])
+                std::memcpy(handle->arrays[first + i], source[i], handle->count * sizeof(T));
+        }
+
+        get_ensemble<T>(handle)->resetEnergy();
+    }
+
+    template<typename T>
+    void copy_out(const PendulumEnsembleHandle* handle, int first, void* const* target, int num)
+    {
+        for (int i = 0; i < num; ++i)
+        {
+            if (target[i] != nullptr && target[i] != handle->arrays[first + i])
+                std::memcpy(target[i], handle->arrays[first + i], handle->count * sizeof(T));
+        }
+    }
+
+    template<typename T>
+    void energy_drift(const PendulumEnsembleHandle* handle, void* drift)
+    {
+        const BasicPendulumEnsemble<T>* ensemble = get_ensemble<T>(handle);
+        T* out = static_cast<T*>(drift);
+
+        for (unsigned int i = 0; i < handle->count; ++i)
+            out[i] = ensemble->getEnergyDrift(i);
+    }
+
+    PendulumEnsembleHandle* make_handle(unsigned int count, PendulumScalar scalar, void* const* arrays)
+    {
+        if (count == 0 || (scalar != PENDULUM_FLOAT32 && scalar != PENDULUM_FLOAT64))
+        {
+            fail(PENDULUM_ERROR_ARGUMENT, "Uncorrect count of pendulums or scalar type");
+            return nullptr;
+        }
+
+        try
+        {
+            std::unique_ptr<PendulumEnsembleHandle> handle(new PendulumEnsembleHandle);
+            handle->scalar = scalar;
+            handle->count = count;
+
+            if (arrays != nullptr)
+            {
+                for (int i = 0; i < NumArrays; ++i)
+                {
+                    if (arrays[i] == nullptr)
+                    {
+                        fail(PENDULUM_ERROR_ARGUMENT, "Null array passed to pendulum_ensemble_wrap");
+                        return nullptr;
+                    }
+                    handle->arrays[i] = arrays[i];
+                }
+            }
+            else if (scalar == PENDULUM_FLOAT32)
+            {
+                const float defaults[NumArrays] = { PendulumConstants<float>::pi / 2, 0, PendulumConstants<float>::pi / 2, 0, 1, 1, 1, 1 };
+
+                handle->storage_float.resize(size_t(NumArrays) * count);
+                for (int i = 0; i < NumArrays; ++i)
+                {
+                    handle->arrays[i] = handle->storage_float.data() + size_t(i) * count;
+                    std::fill_n(handle->storage_float.data() + size_t(i) * count, count, defaults[i]);
+                }
+            }
+            else
+            {
+                const double defaults[NumArrays] = { PendulumConstants<double>::pi / 2, 0, PendulumConstants<double>::pi / 2, 0, 1, 1, 1, 1 };
+
+                handle->storage_double.resize(size_t(NumArrays) * count);
+                for (int i = 0; i < NumArrays; ++i)
+                {
+                    handle->arrays[i] = handle->storage_double.data() + size_t(i) * count;
+                    std::fill_n(handle->storage_double.data() + size_t(i) * count, count, defaults[i]);
+                }
+            }
+
+            if (scalar == PENDULUM_FLOAT32)
+                create_ensemble<float>(handle.get());
+            else
+                create_ensemble<double>(handle.get());
+
+            return handle.release();
+        }
+        catch (const std::bad_alloc&)
+        {
+            fail(PENDULUM_ERROR_MEMORY, "Not enough memory for the ensemble");
+            return nullptr;
+        }
+    }
+}
+
+unsigned int pendulum_abi_version(void)
+{
+    return PENDULUM_ABI_VERSION;
+}
+
+const char* pendulum_last_error(void)
+{
+    return last_error.c_str();
+}
+
+PendulumEnsembleHandle* pendulum_ensemble_create(unsigned int count, PendulumScalar scalar)
+{
+    return make_handle(count, scalar, nullptr);
+}
+
+PendulumEnsembleHandle* pendulum_ensemble_wrap(unsigned int count, PendulumScalar scalar,
+                                               void* theta1, void* omega1, void* theta2, void* omega2,
+                                               void* mass1, void* l1, void* mass2, void* l2)
+{
+    void* const arrays[NumArrays] = { theta1, omega1, theta2, omega2, mass1, l1, mass2, l2 };
+    return make_handle(count, scalar, arrays);
+}
+
+void pendulum_ensemble_destroy(PendulumEnsembleHandle* ensemble)
+{
+    delete ensemble;
+}
+
+unsigned int pendulum_ensemble_count(const PendulumEnsembleHandle* ensemble)
+{
+    return ensemble != nullptr ? ensemble->count : 0;
+}
+
+PendulumScalar pendulum_ensemble_scalar(const PendulumEnsembleHandle* ensemble)
+{
+    return ensemble != nullptr ? ensemble->scalar : PENDULUM_FLOAT32;
+}
+
+int pendulum_ensemble_set_parameters(PendulumEnsembleHandle* ensemble,
+                                     const void* mass1, const void* l1, const void* mass2, const void* l2)
+{
+    if (ensemble == nullptr)
+        return fail(PENDULUM_ERROR_ARGUMENT, "Null ensemble");
+
+    const void* const source[] = { mass1, l1, mass2, l2 };
+    if (ensemble->scalar == PENDULUM_FLOAT32)
+        copy_in<float>(ensemble, Mass1, source, 4);
+    else
+        copy_in<double>(ensemble, Mass1, source, 4);
+
+    return PENDULUM_OK;
+}
+
+int pendulum_ensemble_set_state(PendulumEnsembleHandle* ensemble,
+                                const void* theta1, const void* omega1, const void* theta2, const void* omega2)
+{
+    if (ensemble == nullptr)
+        return fail(PENDULUM_ERROR_ARGUMENT, "Null ensemble");
+
+    const void* const source[] = { theta1, omega1, theta2, omega2 };
+    if (ensemble->scalar == PENDULUM_FLOAT32)
+        copy_in<float>(ensemble, Theta1, source, 4);
+    else
+        copy_in<double>(ensemble, Theta1, source, 4);
+
+    return PENDULUM_OK;
+}
+
+int pendulum_ensemble_get_state(const PendulumEnsembleHandle* ensemble,
+                                void* theta1, void* omega1, void* theta2, void* omega2)
+{
+    if (ensemble == nullptr)
+        return fail(PENDULUM_ERROR_ARGUMENT, "Null ensemble");
+
+    void* const target[] = { theta1, omega1, theta2, omega2 };
+    if (ensemble->scalar == PENDULUM_FLOAT32)
+        copy_out<float>(ensemble, Theta1, target, 4);
+    else
+        copy_out<double>(ensemble, Theta1, target, 4);
+
+    return PENDULUM_OK;
+}
+
+int pendulum_ensemble_get_energy_drift(const PendulumEnsembleHandle* ensemble, void* drift)
+{
+    if (ensemble == nullptr || drift == nullptr)
+        return fail(PENDULUM_ERROR_ARGUMENT, "Null ensemble or array");
+
+    if (ensemble->scalar == PENDULUM_FLOAT32)
+        energy_drift<float>(ensemble, drift);
+    else
+        energy_drift<double>(ensemble, drift);
+
+    return PENDULUM_OK;
+}
+
+int pendulum_ensemble_reset_energy(PendulumEnsembleHandle* ensemble)
+{
+    if (ensemble == nullptr)
+        return fail(PENDULUM_ERROR_ARGUMENT, "Null ensemble");
+
+    if (ensemble->scalar == PENDULUM_FLOAT32)
+        ensemble->ensemble_float->resetEnergy();
+    else
+        ensemble->ensemble_double->resetEnergy();
+
+    return PENDULUM_OK;
+}
+
+int pendulum_ensemble_set_drift_control(PendulumEnsembleHandle* ensemble, double threshold, unsigned int max_substeps)
+{
+    if (ensemble == nullptr)
+        return fail(PENDULUM_ERROR_ARGUMENT, "Null ensemble");
+
+    if (ensemble->scalar == PENDULUM_FLOAT32)
+    {
+        ensemble->ensemble_float->setDriftThreshold((float)threshold);
+        ensemble->ensemble_float->setMaxSubsteps(max_substeps);
+    }
+    else
+    {
+        ensemble->ensemble_double->setDriftThreshold(threshold);
+        ensemble->ensemble_double->setMaxSubsteps(max_substeps);
+    }
+
+    return PENDULUM_OK;
+}
+
+unsigned long long pendulum_ensemble_count_refined_steps(const PendulumEnsembleHandle* ensemble)
+{
+    if (ensemble == nullptr)
+        return 0;
+
+    return ensemble->scalar == PENDULUM_FLOAT32 ? ensemble->ensemble_float->countRefinedSteps()
+                                                : ensemble->ensemble_double->countRefinedSteps();
+}
+
+int pendulum_ensemble_step(PendulumEnsembleHandle* ensemble, double step, unsigned int steps)
+{
+    if (ensemble == nullptr)
+        return fail(PENDULUM_ERROR_ARGUMENT, "Null ensemble");
+
+    return pendulum_ensemble_step_range(ensemble, step, steps, 0, ensemble->count);
+}
+
+int pendulum_ensemble_step_range(PendulumEnsembleHandle* ensemble, double step, unsigned int steps,
+                                 unsigned int begin, unsigned int end)
+{
+    if (ensemble == nullptr)
+        return fail(PENDULUM_ERROR_ARGUMENT, "Null ensemble");
+
+    // Checked in the scalar of the ensemble: a tiny double step rounds to a zero float, which the ensemble
+    // would only report on stdout and leave the state unchanged
+    const bool valid_step = ensemble->scalar == PENDULUM_FLOAT32 ? (float)step > 0 && std::isfinite((float)step)
+                                                                 : step > 0 && std::isfinite(step);
+
+    if (!valid_step || begin > end || end > ensemble->count)
+        return fail(PENDULUM_ERROR_ARGUMENT, "Uncorrect step or range of pendulums");
+
+    if (ensemble->scalar == PENDULUM_FLOAT32)
+        ensemble->ensemble_float->calculatePhysicalModel((float)step, steps, begin, end);
+    else
+        ensemble->ensemble_double->calculatePhysicalModel(step, steps, begin, end);
+
+    return PENDULUM_OK;
+}
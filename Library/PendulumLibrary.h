@@ -0,0 +1,84 @@
+#pragma once
+
+/*
+ * C interface of the double pendulum ensemble for hosts such as Python (ctypes, cffi) or Julia.
+ *
+ * An ensemble either owns its arrays or wraps arrays owned by the caller. A wrapped ensemble is
+ * stepped in place: a NumPy array passed to pendulum_ensemble_wrap holds the current state after
+ * every call of pendulum_ensemble_step, nothing is copied in or out. Every call returns to the host,
+ * so long runs are split into batches of steps between which the host may read or change the arrays.
+ *
+ * All arrays hold one element per pendulum, of float or double as chosen at creation.
+ * Functions returning int return PENDULUM_OK or a negative error code, see pendulum_last_error.
+ */
+
+#if defined(_WIN32)
+    #if defined(PENDULUM_LIBRARY_EXPORTS)
+        #define PENDULUM_API __declspec(dllexport)
+    #else
+        #define PENDULUM_API __declspec(dllimport)
+    #endif
+#else
+    #define PENDULUM_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Incremented on any incompatible change of the functions below */
+#define PENDULUM_ABI_VERSION 1
+
+#define PENDULUM_OK 0
+#define PENDULUM_ERROR_ARGUMENT -1
+#define PENDULUM_ERROR_MEMORY -2
+
+typedef enum PendulumScalar
+{
+    PENDULUM_FLOAT32 = 0,
+    PENDULUM_FLOAT64 = 1
+} PendulumScalar;
+
+typedef struct PendulumEnsembleHandle PendulumEnsembleHandle;
+
+PENDULUM_API unsigned int pendulum_abi_version(void);
+/* Message of the last failed call in the calling thread */
+PENDULUM_API const char* pendulum_last_error(void);
+
+/* Ensemble with its own arrays, every pendulum has m = 1, l = 1, theta = pi / 2, omega = 0 */
+PENDULUM_API PendulumEnsembleHandle* pendulum_ensemble_create(unsigned int count, PendulumScalar scalar);
+/* Ensemble over caller arrays, which must outlive it. Initial energies are taken from the current state */
+PENDULUM_API PendulumEnsembleHandle* pendulum_ensemble_wrap(unsigned int count, PendulumScalar scalar,
+                                                            void* theta1, void* omega1, void* theta2, void* omega2,
+                                                            void* mass1, void* l1, void* mass2, void* l2);
+PENDULUM_API void pendulum_ensemble_destroy(PendulumEnsembleHandle* ensemble);
+
+PENDULUM_API unsigned int pendulum_ensemble_count(const PendulumEnsembleHandle* ensemble);
+PENDULUM_API PendulumScalar pendulum_ensemble_scalar(const PendulumEnsembleHandle* ensemble);
+
+/* Copy into the ensemble arrays (skipped for arrays the ensemble wraps) and reset the initial energies */
+PENDULUM_API int pendulum_ensemble_set_parameters(PendulumEnsembleHandle* ensemble,
+                                                  const void* mass1, const void* l1, const void* mass2, const void* l2);
+PENDULUM_API int pendulum_ensemble_set_state(PendulumEnsembleHandle* ensemble,
+                                             const void* theta1, const void* omega1, const void* theta2, const void* omega2);
+/* Copy out of the ensemble arrays, null pointers are skipped */
+PENDULUM_API int pendulum_ensemble_get_state(const PendulumEnsembleHandle* ensemble,
+                                             void* theta1, void* omega1, void* theta2, void* omega2);
+/* Energy drift of every pendulum relative to its initial energy */
+PENDULUM_API int pendulum_ensemble_get_energy_drift(const PendulumEnsembleHandle* ensemble, void* drift);
+/* Takes the current state as the initial one for the drift, to be called after the arrays are changed by the host */
+PENDULUM_API int pendulum_ensemble_reset_energy(PendulumEnsembleHandle* ensemble);
+
+/* Re-integration of steps whose energy drift is above the threshold, threshold <= 0 disables it */
+PENDULUM_API int pendulum_ensemble_set_drift_control(PendulumEnsembleHandle* ensemble, double threshold, unsigned int max_substeps);
+PENDULUM_API unsigned long long pendulum_ensemble_count_refined_steps(const PendulumEnsembleHandle* ensemble);
+
+/* Advances every pendulum by steps steps of RK4 in place, the step must be positive and finite in the scalar type */
+PENDULUM_API int pendulum_ensemble_step(PendulumEnsembleHandle* ensemble, double step, unsigned int steps);
+/* Advances pendulums [begin, end) only, so that host threads may step disjoint ranges of one ensemble */
+PENDULUM_API int pendulum_ensemble_step_range(PendulumEnsembleHandle* ensemble, double step, unsigned int steps,
+                                              unsigned int begin, unsigned int end);
+
+#ifdef __cplusplus
+}
+#endif
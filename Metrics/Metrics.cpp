@@ -0,0 +1,49 @@
+#include "Metrics.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+    std::string format_value(double value)
+    {
+        if (std::isnan(value))
+            return "NaN";
+        if (std::isinf(value))
+            return value > 0 ? "+Inf" : "-Inf";
+
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.17g", value);
+        return text;
+    }
+}
+
+Counter& MetricsRegistry::addCounter(const std::string& name, const std::string& help)
+{
+    counters.emplace_back();
+    metrics.push_back({ name, help, &counters.back(), nullptr });
+
+    return counters.back();
+}
+
+Gauge& MetricsRegistry::addGauge(const std::string& name, const std::string& help)
+{
+    gauges.emplace_back();
+    metrics.push_back({ name, help, nullptr, &gauges.back() });
+
+    return gauges.back();
+}
+
+std::string MetricsRegistry::format() const
+{
+    std::string text;
+
+    for (const Metric& metric : metrics)
+    {
+        text += "# HELP " + metric.name + " " + metric.help + "\n";
+        text += "# TYPE " + metric.name + (metric.counter ? " counter\n" : " gauge\n");
+        text += metric.name + " " + (metric.counter ? std::to_string(metric.counter->get()) : format_value(metric.gauge->get())) + "\n";
+    }
+
+    return text;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+// Monotonic count, updated from the hot loops with one relaxed atomic addition
+class Counter
+{
+public:
+    void increment(unsigned long long value = 1) { count.fetch_add(value, std::memory_order_relaxed); }
+    unsigned long long get() const { return count.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<unsigned long long> count{ 0 };
+};
+
+// Last value set, the bits of the double are kept in a 64-bit atomic so that setting it is one relaxed store
+class Gauge
+{
+public:
+    void set(double value)
+    {
+        uint64_t word;
+        std::memcpy(&word, &value, sizeof(word));
+        bits.store(word, std::memory_order_relaxed);
+    }
+
+    double get() const
+    {
+        const uint64_t word = bits.load(std::memory_order_relaxed);
+        double value;
+        std::memcpy(&value, &word, sizeof(value));
+        return value;
+    }
+
+private:
+    // All zero bits are 0.0
+    std::atomic<uint64_t> bits{ 0 };
+};
+
+// Named counters and gauges in the Prometheus text format.
+// Metrics are added before serving starts and stay at the same address while the registry lives,
+// after that the registry is only read and formatting never blocks the threads updating the metrics
+class MetricsRegistry
+{
+public:
+    Counter& addCounter(const std::string& name, const std::string& help);
+    Gauge& addGauge(const std::string& name, const std::string& help);
+
+    // Text exposition format 0.0.4
+    std::string format() const;
+
+private:
+    struct Metric
+    {
+        std::string name;
+        std::string help;
+        const Counter* counter;
+        const Gauge* gauge;
+    };
+
+    std::deque<Counter> counters;
+    std::deque<Gauge> gauges;
+    std::vector<Metric> metrics;
+};
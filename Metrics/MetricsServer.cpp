@@ -0,0 +1,280 @@
+#include "MetricsServer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "Ws2_32.lib")
+
+    typedef SOCKET socket_t;
+#else
+    #include <unistd.h>
+    #include <sys/time.h>
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <sys/select.h>
+    #include <sys/un.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+
+    typedef int socket_t;
+#endif
+
+namespace
+{
+    // How often the serving thread checks whether it was stopped
+    const int poll_interval_ms = 200;
+    // A scraper not sending its request or not reading the response in time is dropped
+    const int client_timeout_ms = 1000;
+
+    socket_t to_socket(long long handle)
+    {
+        return (socket_t)handle;
+    }
+
+    void close_socket(socket_t handle)
+    {
+#ifdef _WIN32
+        closesocket(handle);
+#else
+        close(handle);
+#endif
+    }
+
+    bool is_valid(socket_t handle)
+    {
+#ifdef _WIN32
+        return handle != INVALID_SOCKET;
+#else
+        return handle >= 0;
+#endif
+    }
+
+    void set_timeouts(socket_t handle, int milliseconds)
+    {
+#ifdef _WIN32
+        DWORD timeout = (DWORD)milliseconds;
+#else
+        timeval timeout;
+        timeout.tv_sec = milliseconds / 1000;
+        timeout.tv_usec = (milliseconds % 1000) * 1000;
+#endif
+        setsockopt(handle, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        setsockopt(handle, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+    }
+
+    bool send_all(socket_t handle, const std::string& data)
+    {
+#ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL;
+#else
+        const int flags = 0;
+#endif
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            const int result = (int)send(handle, data.data() + sent, (int)(data.size() - sent), flags);
+            if (result <= 0)
+                return false;
+
+            sent += (size_t)result;
+        }
+
+        return true;
+    }
+}
+
+MetricsServer::MetricsServer(const MetricsRegistry& p_registry) :
+    registry(p_registry)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+bool MetricsServer::start(const std::string& address)
+{
+    stop();
+
+#ifdef _WIN32
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0)
+    {
+        std::cout << "Failed to initialize Winsock" << std::endl;
+        return false;
+    }
+#endif
+
+    socket_t handle;
+
+    if (address.compare(0, 5, "unix:") == 0)
+    {
+#ifdef _WIN32
+        std::cout << "Unix-domain sockets are not supported for metrics on Windows, use a port" << std::endl;
+        WSACleanup();
+        return false;
+#else
+        const std::string path = address.substr(5);
+
+        sockaddr_un local = {};
+        local.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(local.sun_path))
+        {
+            std::cout << "Invalid metrics socket path: " << path << std::endl;
+            return false;
+        }
+        path.copy(local.sun_path, path.size());
+
+        handle = socket(AF_UNIX, SOCK_STREAM, 0);
+        // A socket file left by a previous run would fail the bind
+        unlink(path.c_str());
+
+        if (!is_valid(handle) || bind(handle, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) != 0 || listen(handle, 4) != 0)
+        {
+            std::cout << "Failed to listen for metrics on " << path << std::endl;
+            if (is_valid(handle))
+                close_socket(handle);
+            return false;
+        }
+
+        unix_path = path;
+#endif
+    }
+    else
+    {
+        char* end = nullptr;
+        const unsigned long port = std::strtoul(address.c_str(), &end, 10);
+        if (address.empty() || *end != '\0' || port == 0 || port > 65535)
+        {
+            std::cout << "Invalid metrics address: " << address << std::endl;
+#ifdef _WIN32
+            WSACleanup();
+#endif
+            return false;
+        }
+
+        // Loopback only, the metrics are for the local host
+        sockaddr_in local = {};
+        local.sin_family = AF_INET;
+        local.sin_port = htons((unsigned short)port);
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        handle = socket(AF_INET, SOCK_STREAM, 0);
+
+        const int reuse = 1;
+        if (is_valid(handle))
+            setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        if (!is_valid(handle) || bind(handle, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) != 0 || listen(handle, 4) != 0)
+        {
+            std::cout << "Failed to listen for metrics on port " << port << std::endl;
+            if (is_valid(handle))
+                close_socket(handle);
+#ifdef _WIN32
+            WSACleanup();
+#endif
+            return false;
+        }
+    }
+
+    listener = (long long)handle;
+    running = true;
+    thread = std::thread(&MetricsServer::serve, this);
+
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if (!running)
+        return;
+
+    running = false;
+    thread.join();
+
+    close_socket(to_socket(listener));
+    listener = -1;
+
+#ifdef _WIN32
+    WSACleanup();
+#else
+    if (!unix_path.empty())
+        unlink(unix_path.c_str());
+#endif
+    unix_path.clear();
+}
+
+void MetricsServer::serve()
+{
+    const socket_t handle = to_socket(listener);
+
+    while (running)
+    {
+        // Waits for a connection with a timeout, so that stop() is noticed
+        fd_set ready;
+        FD_ZERO(&ready);
+        FD_SET(handle, &ready);
+
+        timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = poll_interval_ms * 1000;
+
+        if (select((int)handle + 1, &ready, nullptr, nullptr, &timeout) <= 0)
+            continue;
+
+        const socket_t client = accept(handle, nullptr, nullptr);
+        if (!is_valid(client))
+            continue;
+
+        set_timeouts(client, client_timeout_ms);
+        respond((long long)client);
+        close_socket(client);
+    }
+}
+
+void MetricsServer::respond(long long client_handle)
+{
+    const socket_t client = to_socket(client_handle);
+
+    // Only the request line matters, the rest of the request is not read
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n") == std::string::npos && request.size() < 4096)
+    {
+        const int received = (int)recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+            return;
+
+        request.append(buffer, (size_t)received);
+    }
+
+    std::string status = "200 OK";
+    std::string body;
+
+    if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 13, "GET /metrics?") == 0)
+    {
+        body = registry.format();
+        ++scrapes;
+    }
+    else
+    {
+        status = "404 Not Found";
+        body = "Metrics are served at /metrics\n";
+    }
+
+    const std::string response = "HTTP/1.1 " + status + "\r\n"
+        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n"
+        "\r\n" + body;
+
+    send_all(client, response);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "Metrics.h"
+
+// Serves the registry over HTTP (GET /metrics) on a background thread, one connection at a time.
+// The thread only reads the metrics, so a slow or stuck scraper delays other scrapes, never the loops updating them
+class MetricsServer
+{
+public:
+    MetricsServer(const MetricsRegistry& p_registry);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // address - a port on the loopback interface ("9464"),
+    //           or a Unix-domain socket ("unix:/tmp/pendulum.sock", not on Windows)
+    bool start(const std::string& address);
+    void stop();
+
+    bool isRunning() const { return running; }
+    unsigned long long countScrapes() const { return scrapes; }
+
+private:
+    const MetricsRegistry& registry;
+
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    std::atomic<unsigned long long> scrapes{ 0 };
+
+    // Listening socket, -1 when closed
+    long long listener = -1;
+    std::string unix_path;
+
+    void serve();
+    void respond(long long client);
+};
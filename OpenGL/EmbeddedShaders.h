@@ -0,0 +1,9 @@
+#ifndef EMBEDDED_SHADERS_H
+#define EMBEDDED_SHADERS_H
+
+// Shader sources of Resources, embedded at build time by Resources/EmbedShader.ps1
+// into $(IntDir)Shaders, one header and one array per shader: default.vert -> default_vert
+#include "default.vert.h"
+#include "default.frag.h"
+
+#endif
@@ -1,33 +1,98 @@
 #include "ShaderClass.h"
 
-std::string get_file_contents(const char* filename)
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <GLFW/glfw3.h>
+
+// Program binaries are core since OpenGL 4.1 (ARB_get_program_binary), the context is 3.3, so the
+// entry points are looked up at run time and the cache is silently skipped where they are missing
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (APIENTRY* GetProgramBinaryProc)(GLuint program, GLsizei buffer_size, GLsizei* length, GLenum* format, void* binary);
+typedef void (APIENTRY* ProgramBinaryProc)(GLuint program, GLenum format, const void* binary, GLsizei length);
+typedef void (APIENTRY* ProgramParameteriProc)(GLuint program, GLenum name, GLint value);
+
+namespace
 {
-    std::ifstream in(filename, std::ios::binary);
+    const char binary_magic[4] = { 'P', 'S', 'P', 'B' };
 
-    if (in)
+    struct BinaryHeader
     {
-        std::string contents;
-        in.seekg(0, std::ios::end);
-        contents.resize(in.tellg());
-
-        in.seekg(0, std::ios::beg);
-        in.read(&contents[0], contents.size());
+        char magic[4];
+        uint32_t format;
+        uint64_t key;
+        uint32_t length;
+        uint32_t reserved;
+    };
+
+    bool binaries_supported()
+    {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        // Clears GL_INVALID_ENUM of drivers without the extension
+        while (glGetError() != GL_NO_ERROR)
+            ;
 
-        in.close();
-        return(contents);
+        return formats > 0 && glfwGetProcAddress("glGetProgramBinary") && glfwGetProcAddress("glProgramBinary");
     }
 
-    throw(errno);
+    // FNV-1a over the driver strings and the sources, a binary is valid for this driver and these sources only
+    unsigned long long program_key(const char* vertex_source, const char* fragment_source)
+    {
+        const char* parts[] = {
+            reinterpret_cast<const char*>(glGetString(GL_VENDOR)),
+            reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+            reinterpret_cast<const char*>(glGetString(GL_VERSION)),
+            vertex_source,
+            fragment_source
+        };
+
+        unsigned long long hash = 14695981039346656037ull;
+        for (const char* part : parts)
+        {
+            for (const char* c = part ? part : ""; ; ++c)
+            {
+                hash ^= (unsigned char)*c;
+                hash *= 1099511628211ull;
+
+                // The terminating zero separates the parts
+                if (*c == '\0')
+                    break;
+            }
+        }
+
+        return hash;
+    }
 }
 
-Shader::Shader(const char* vertex_file, const char* fragment_file)
+Shader::Shader(const char* vertex_source, const char* fragment_source, const char* binary_cache)
 {
-    std::string vertex_code = get_file_contents(vertex_file);
-    std::string fragment_code = get_file_contents(fragment_file);
+    const bool use_cache = binary_cache != nullptr && binaries_supported();
+    const unsigned long long key = use_cache ? program_key(vertex_source, fragment_source) : 0;
 
-    const char* vertex_source = vertex_code.c_str();
-    const char* fragment_source = fragment_code.c_str();
+    if (use_cache && loadBinary(binary_cache, key))
+    {
+        loaded_from_cache = true;
+        return;
+    }
+
+    compileProgram(vertex_source, fragment_source);
+
+    if (use_cache)
+        saveBinary(binary_cache, key);
+}
 
+void Shader::compileProgram(const char* vertex_source, const char* fragment_source)
+{
     // Create Vertex Shader Object and get reference
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
     // Attach Vertex Shader source to the Vertex Shader Object
@@ -50,6 +115,10 @@ Shader::Shader(const char* vertex_file, const char* fragment_file)
     // Attach Vertex and Fragment Shaders to the Shader Program
     glAttachShader(ID, vertexShader);
     glAttachShader(ID, fragmentShader);
+    // Ask the driver to keep the binary retrievable for the cache
+    ProgramParameteriProc program_parameter = (ProgramParameteriProc)glfwGetProcAddress("glProgramParameteri");
+    if (program_parameter)
+        program_parameter(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     // Wrap-up/Link all the shaders together into the Shader Programd
     glLinkProgram(ID);
     compileErrors(ID, "PROGRAM");
@@ -59,6 +128,76 @@ Shader::Shader(const char* vertex_file, const char* fragment_file)
     glDeleteShader(fragmentShader);
 }
 
+bool Shader::loadBinary(const char* filename, unsigned long long key)
+{
+    std::ifstream in(filename, std::ios::binary);
+    BinaryHeader header;
+
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, binary_magic, sizeof(binary_magic)) != 0
+        || header.key != key
+        || header.length == 0)
+        return false;
+
+    std::vector<char> binary(header.length);
+    if (!in.read(binary.data(), binary.size()))
+        return false;
+
+    ProgramBinaryProc program_binary = (ProgramBinaryProc)glfwGetProcAddress("glProgramBinary");
+
+    ID = glCreateProgram();
+    program_binary(ID, header.format, binary.data(), (GLsizei)binary.size());
+
+    // A driver may still reject its own binary, e.g. after an update keeping the version string
+    GLint linked = GL_FALSE;
+    glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+    {
+        glDeleteProgram(ID);
+        ID = 0;
+        while (glGetError() != GL_NO_ERROR)
+            ;
+
+        return false;
+    }
+
+    return true;
+}
+
+void Shader::saveBinary(const char* filename, unsigned long long key)
+{
+    GLint linked = GL_FALSE;
+    glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    BinaryHeader header = {};
+    std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+    header.key = key;
+
+    std::vector<char> binary(length);
+    GLsizei written = 0;
+    GLenum format = 0;
+
+    GetProgramBinaryProc get_program_binary = (GetProgramBinaryProc)glfwGetProcAddress("glGetProgramBinary");
+    get_program_binary(ID, length, &written, &format, binary.data());
+    if (written <= 0)
+        return;
+
+    header.format = format;
+    header.length = (uint32_t)written;
+
+    // A broken file only costs one compilation on the next launch
+    std::ofstream out(filename, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(binary.data(), written);
+}
+
 void Shader::Activate()
 {
     glUseProgram(ID);
@@ -74,7 +213,7 @@ void Shader::compileErrors(unsigned int shader, const char* type)
     GLint has_compiled;
     char info_log[1024];
 
-    if (type != "PROGRAM")
+    if (std::strcmp(type, "PROGRAM") != 0)
     {
         glGetShaderiv(shader, GL_COMPILE_STATUS, &has_compiled);
 
@@ -4,24 +4,31 @@
 #include <glad/glad.h>
 #include <string>
 #include <fstream>
-#include <sstream>
 #include <iostream>
-#include <cerrno>
-
-std::string get_file_contents(const char* filename);
 
 class Shader
 {
 public:
     GLuint ID;
-    
-    Shader(const char* vertex_file, const char* fragment_file);
+
+    // Program from sources in memory (see EmbeddedShaders.h).
+    // With binary_cache the linked program is kept in that file and loaded from it on later launches,
+    // as long as the driver and the sources are the same; otherwise the sources are compiled as usual
+    Shader(const char* vertex_source, const char* fragment_source, const char* binary_cache = nullptr);
 
     void Activate();
     void Delete();
 
+    bool isLoadedFromCache() const { return loaded_from_cache; }
+
 private:
+    bool loaded_from_cache = false;
+
     void compileErrors(unsigned int shader, const char* type);
+
+    void compileProgram(const char* vertex_source, const char* fragment_source);
+    bool loadBinary(const char* filename, unsigned long long key);
+    void saveBinary(const char* filename, unsigned long long key);
 };
 
 #endif
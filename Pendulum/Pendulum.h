@@ -1,49 +1,21 @@
 #pragma once
-#define _USE_MATH_DEFINES
 
-#include <math.h>
-#include <vector>
-#include <iostream>
 #include <glad/glad.h>
 
 #include "VAO.h"
 #include "VBO.h"
 #include "EBO.h"
 
-struct Beam
-{
-    Beam(float p_mass = 1.0f, float p_l = 1.0f, float p_theta = M_PI / 2, float p_omega = 0.0f) :
-        x(0.0f),
-        y(0.0f),
-        z(0.0f),
-        mass(p_mass),
-        l(p_l),
-        theta(p_theta),
-        omega(p_omega)
-    {
-        x = l * sin(theta) / 2;
-        y = -l * cos(theta) / 2;
-    };
-
-    float x;
-    float y;
-    float z;
-
-    float mass;
-    float l;
-    float theta;
-    float omega;
-};
+#include "PendulumModel.h"
 
-class DoublePendulum
+class DoublePendulum : public DoublePendulumModel
 {
 public:
     DoublePendulum(float* mass_beams, float* l_beams, float* theta_beams, float* omega_beams);
     ~DoublePendulum();
 
-    void calculatePhysicalModel(float step);
-
-    unsigned int countBeams() const { return beams.size(); }
+    void calculatePhysicalModel(float step) override;
+    void loadSnapshot(const Snapshot& snapshot) override;
 
     GLfloat* getDrawVertices() const { return vertices; }
     GLuint countDrawVertices() const { return countBeams() * 4 * 3; }
@@ -65,8 +37,6 @@ public:
 
 protected:
 
-    std::vector<Beam> beams;
-
     GLfloat* vertices = nullptr;
     GLuint* edge_indices = nullptr;
     GLuint* surface_indices = nullptr;
@@ -75,8 +45,4 @@ protected:
     VBO vbo;
     EBO edge_ebo;
     EBO surface_ebo;
-
-private:
-    void calculateDerivates(const float* y_in, float* derivates);
-    void updateCoordinates();
 };
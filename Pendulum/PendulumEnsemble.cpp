@@ -0,0 +1,316 @@
+#include "PendulumEnsemble.h"
+
+#include <algorithm>
+
+template<typename T, typename E>
+BasicPendulumEnsemble<T, E>::BasicPendulumEnsemble(unsigned int p_count) : count(p_count)
+{
+    theta1 = new T[count] {};
+    omega1 = new T[count] {};
+    theta2 = new T[count] {};
+    omega2 = new T[count] {};
+
+    mass1 = new T[count] {};
+    l1 = new T[count] {};
+    mass2 = new T[count] {};
+    l2 = new T[count] {};
+
+    allocateEnergy();
+
+    const T mass_beams[2] = { 1, 1 }, l_beams[2] = { 1, 1 };
+    const T theta_beams[2] = { PendulumConstants<T>::pi / 2, PendulumConstants<T>::pi / 2 }, omega_beams[2] = { 0, 0 };
+
+    for (unsigned int i = 0; i < count; ++i)
+        setPendulum(i, mass_beams, l_beams, theta_beams, omega_beams);
+}
+
+template<typename T, typename E>
+BasicPendulumEnsemble<T, E>::BasicPendulumEnsemble(unsigned int p_count, T* p_theta1, T* p_omega1, T* p_theta2, T* p_omega2,
+                                                   T* p_mass1, T* p_l1, T* p_mass2, T* p_l2) :
+    count(p_count),
+    owns_state(false),
+    theta1(p_theta1),
+    omega1(p_omega1),
+    theta2(p_theta2),
+    omega2(p_omega2),
+    mass1(p_mass1),
+    l1(p_l1),
+    mass2(p_mass2),
+    l2(p_l2)
+{
+    allocateEnergy();
+    resetEnergy();
+}
+
+template<typename T, typename E>
+BasicPendulumEnsemble<T, E>::~BasicPendulumEnsemble()
+{
+    T** state_arrays[] = { &theta1, &omega1, &theta2, &omega2, &mass1, &l1, &mass2, &l2 };
+    T** energy_arrays[] = { &energy, &initial_energy, &energy_scale };
+
+    for (T** array : state_arrays)
+    {
+        if (owns_state)
+            delete[] *array;
+        *array = nullptr;
+    }
+
+    for (T** array : energy_arrays)
+    {
+        delete[] *array;
+        *array = nullptr;
+    }
+}
+
+template<typename T, typename E>
+void BasicPendulumEnsemble<T, E>::allocateEnergy()
+{
+    energy = new T[count] {};
+    initial_energy = new T[count] {};
+    energy_scale = new T[count] {};
+}
+
+template<typename T, typename E>
+void BasicPendulumEnsemble<T, E>::setPendulum(unsigned int i, const T* mass_beams, const T* l_beams, const T* theta_beams, const T* omega_beams)
+{
+    if (i >= count)
+    {
+        std::cout << "Pendulum index " << i << " is out of ensemble of " << count << std::endl;
+        return;
+    }
+
+    mass1[i] = mass_beams[0];
+    mass2[i] = mass_beams[1];
+    l1[i] = l_beams[0];
+    l2[i] = l_beams[1];
+
+    theta1[i] = theta_beams[0];
+    theta2[i] = theta_beams[1];
+    omega1[i] = omega_beams[0];
+    omega2[i] = omega_beams[1];
+
+    energy[i] = initial_energy[i] = calculateEnergy(i);
+
+    // Same scale as in BasicDoublePendulumModel
+    energy_scale[i] = PendulumConstants<T>::gravity * ((mass1[i] + mass2[i]) * l1[i] + mass2[i] * l2[i]);
+    if (std::fabs(initial_energy[i]) > energy_scale[i])
+        energy_scale[i] = std::fabs(initial_energy[i]);
+}
+
+template<typename T, typename E>
+void BasicPendulumEnsemble<T, E>::getState(unsigned int i, T* y) const
+{
+    y[0] = theta1[i];
+    y[1] = omega1[i];
+    y[2] = theta2[i];
+    y[3] = omega2[i];
+}
+
+template<typename T, typename E>
+void BasicPendulumEnsemble<T, E>::resetEnergy()
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        energy[i] = initial_energy[i] = calculateEnergy(i);
+
+        energy_scale[i] = PendulumConstants<T>::gravity * ((mass1[i] + mass2[i]) * l1[i] + mass2[i] * l2[i]);
+        if (std::fabs(initial_energy[i]) > energy_scale[i])
+            energy_scale[i] = std::fabs(initial_energy[i]);
+    }
+}
+
+template<typename T, typename E>
+void BasicPendulumEnsemble<T, E>::saveSnapshot(Snapshot& snapshot) const
+{
+    const T* arrays[] = { theta1, omega1, theta2, omega2, energy };
+
+    snapshot.resize(5 * size_t(count));
+    for (size_t a = 0; a < 5; ++a)
+        std::copy(arrays[a], arrays[a] + count, snapshot.begin() + a * count);
+}
+
+template<typename T, typename E>
+void BasicPendulumEnsemble<T, E>::loadSnapshot(const Snapshot& snapshot)
+{
+    T* arrays[] = { theta1, omega1, theta2, omega2, energy };
+
+    if (snapshot.size() != 5 * size_t(count))
+    {
+        std::cout << "Snapshot of " << snapshot.size() / 5 << " pendulums does not fit ensemble of " << count << std::endl;
+        return;
+    }
+
+    for (size_t a = 0; a < 5; ++a)
+        std::copy(snapshot.begin() + a * count, snapshot.begin() + (a + 1) * count, arrays[a]);
+}
+
+template<typename T, typename E>
+T BasicPendulumEnsemble<T, E>::calculateEnergy(unsigned int i) const
+{
+    T kinetic = 0, potential = 0;
+    pendulum_energy<T>(omega1[i], omega2[i],
+                       std::sin(theta1[i]), std::cos(theta1[i]), std::sin(theta2[i]), std::cos(theta2[i]),
+                       mass1[i], l1[i], mass2[i], l2[i], kinetic, potential);
+
+    return kinetic + potential;
+}
+
+template<typename T, typename E>
+void BasicPendulumEnsemble<T, E>::stepLanes(T* th1, T* w1, T* th2, T* w2, const T* m1, const T* len1, const T* m2, const T* len2, unsigned int n, T h)
+{
+    // Stage increments of theta 1, omega 1, theta 2, omega 2 and the stage state
+    T k_th1[block_size], k_w1[block_size], k_th2[block_size], k_w2[block_size];
+    T s_th1[block_size], s_w1[block_size], s_th2[block_size], s_w2[block_size];
+    T sum_th1[block_size], sum_w1[block_size], sum_th2[block_size], sum_w2[block_size];
+
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        s_th1[i] = th1[i];
+        s_w1[i] = w1[i];
+        s_th2[i] = th2[i];
+        s_w2[i] = w2[i];
+
+        sum_th1[i] = sum_w1[i] = sum_th2[i] = sum_w2[i] = 0;
+    }
+
+    // Stage weights for the final sum and offsets of the next stage state
+    const T weight[4] = { T(1) / 6, T(1) / 3, T(1) / 3, T(1) / 6 };
+    const T offset[4] = { T(1) / 2, T(1) / 2, T(1), T(0) };
+
+    for (int stage = 0; stage < 4; ++stage)
+    {
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            E dw1, dw2;
+            pendulum_accelerations<E>((E)s_th1[i], (E)s_w1[i], (E)s_th2[i], (E)s_w2[i],
+                                      (E)m1[i], (E)len1[i], (E)m2[i], (E)len2[i], dw1, dw2);
+
+            k_th1[i] = h * s_w1[i];
+            k_w1[i] = h * (T)dw1;
+            k_th2[i] = h * s_w2[i];
+            k_w2[i] = h * (T)dw2;
+
+            sum_th1[i] += weight[stage] * k_th1[i];
+            sum_w1[i] += weight[stage] * k_w1[i];
+            sum_th2[i] += weight[stage] * k_th2[i];
+            sum_w2[i] += weight[stage] * k_w2[i];
+
+            s_th1[i] = th1[i] + offset[stage] * k_th1[i];
+            s_w1[i] = w1[i] + offset[stage] * k_w1[i];
+            s_th2[i] = th2[i] + offset[stage] * k_th2[i];
+            s_w2[i] = w2[i] + offset[stage] * k_w2[i];
+        }
+    }
+
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        th1[i] += sum_th1[i];
+        w1[i] += sum_w1[i];
+        th2[i] += sum_th2[i];
+        w2[i] += sum_w2[i];
+    }
+}
+
+template<typename T, typename E>
+void BasicPendulumEnsemble<T, E>::refineLane(unsigned int i, const T* y0, T step)
+{
+    T drift = 0;
+    unsigned int substeps = 1;
+
+    do
+    {
+        substeps = 2 * substeps < max_substeps ? 2 * substeps : max_substeps;
+
+        theta1[i] = y0[0];
+        omega1[i] = y0[1];
+        theta2[i] = y0[2];
+        omega2[i] = y0[3];
+
+        for (unsigned int s = 0; s < substeps; ++s)
+        {
+            stepLanes(theta1 + i, omega1 + i, theta2 + i, omega2 + i, mass1 + i, l1 + i, mass2 + i, l2 + i, 1, step / substeps);
+        }
+
+        drift = std::fabs(calculateEnergy(i) - energy[i]) / energy_scale[i];
+    } while (drift > drift_threshold && substeps < max_substeps);
+
+    ++refined_steps;
+}
+
+template<typename T, typename E>
+void BasicPendulumEnsemble<T, E>::calculatePhysicalModel(T step, unsigned int steps)
+{
+    calculatePhysicalModel(step, steps, 0, count);
+}
+
+template<typename T, typename E>
+void BasicPendulumEnsemble<T, E>::calculatePhysicalModel(T step, unsigned int steps, unsigned int first, unsigned int last)
+{
+    if (step <= 0)
+    {
+        std::cout << "Uncorrect step for calculations." << std::endl;
+        return;
+    }
+
+    if (last > count)
+        last = count;
+
+    const bool monitor = drift_threshold > 0 && max_substeps > 1;
+
+    // State of the block before the current step, kept for re-integration of drifting pendulums
+    T y0[4][block_size];
+
+    // Every block runs all steps while its lanes are in cache
+    for (unsigned int begin = first; begin < last; begin += block_size)
+    {
+        const unsigned int n = last - begin < block_size ? last - begin : block_size;
+
+        for (unsigned int s = 0; s < steps; ++s)
+        {
+            if (monitor)
+            {
+                for (unsigned int i = 0; i < n; ++i)
+                {
+                    y0[0][i] = theta1[begin + i];
+                    y0[1][i] = omega1[begin + i];
+                    y0[2][i] = theta2[begin + i];
+                    y0[3][i] = omega2[begin + i];
+                }
+            }
+
+            stepLanes(theta1 + begin, omega1 + begin, theta2 + begin, omega2 + begin,
+                      mass1 + begin, l1 + begin, mass2 + begin, l2 + begin, n, step);
+
+            if (!monitor)
+                continue;
+
+            // Only the drifting pendulums are re-integrated, the rest keep the coarse step
+            for (unsigned int i = 0; i < n; ++i)
+            {
+                const unsigned int lane = begin + i;
+
+                T step_energy = calculateEnergy(lane);
+                if (std::fabs(step_energy - energy[lane]) / energy_scale[lane] > drift_threshold)
+                {
+                    const T y_lane[4] = { y0[0][i], y0[1][i], y0[2][i], y0[3][i] };
+                    refineLane(lane, y_lane, step);
+                    step_energy = calculateEnergy(lane);
+                }
+
+                energy[lane] = step_energy;
+            }
+        }
+
+        // Without monitoring the energy is needed only for the drift after the last step
+        if (!monitor)
+        {
+            for (unsigned int i = 0; i < n; ++i)
+                energy[begin + i] = calculateEnergy(begin + i);
+        }
+    }
+}
+
+template class BasicPendulumEnsemble<float>;
+template class BasicPendulumEnsemble<double>;
+template class BasicPendulumEnsemble<double, float>;
+template class BasicPendulumEnsemble<long double>;
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cmath>
+#include <atomic>
+#include <vector>
+#include <iostream>
+
+#include "PendulumEquations.h"
+
+// Many independent double pendulums stored as structure of arrays and stepped together with RK4,
+// so that the loops over pendulums vectorize: a float ensemble fits twice as many lanes in a SIMD register.
+// T - scalar type of parameters and accumulated state
+// E - scalar type in which the accelerations are evaluated (float with double state for mixed precision)
+template<typename T, typename E = T>
+class BasicPendulumEnsemble
+{
+public:
+    // Lanes are stepped in blocks of this size so that the stage arrays stay in cache
+    static const unsigned int block_size = 256;
+
+    // theta 1, omega 1, theta 2, omega 2 and energy of all pendulums, array after array
+    using Snapshot = std::vector<T>;
+
+public:
+    BasicPendulumEnsemble(unsigned int count);
+    // View over caller-owned arrays of count elements each: state is stepped in place, nothing is copied
+    BasicPendulumEnsemble(unsigned int count, T* theta1, T* omega1, T* theta2, T* omega2, T* mass1, T* l1, T* mass2, T* l2);
+    virtual ~BasicPendulumEnsemble();
+
+    BasicPendulumEnsemble(const BasicPendulumEnsemble&) = delete;
+    BasicPendulumEnsemble& operator=(const BasicPendulumEnsemble&) = delete;
+
+    unsigned int countPendulums() const { return count; }
+
+    void setPendulum(unsigned int i, const T* mass_beams, const T* l_beams, const T* theta_beams, const T* omega_beams);
+    // theta 1, omega 1, theta 2, omega 2
+    void getState(unsigned int i, T* y) const;
+
+    // Advances every pendulum by the given number of steps
+    void calculatePhysicalModel(T step, unsigned int steps = 1);
+    // Advances pendulums [begin, end) only, disjoint ranges may be stepped from different threads
+    void calculatePhysicalModel(T step, unsigned int steps, unsigned int begin, unsigned int end);
+
+    bool isView() const { return !owns_state; }
+
+    T* getTheta(unsigned int beam) { return beam == 0 ? theta1 : theta2; }
+    T* getOmega(unsigned int beam) { return beam == 0 ? omega1 : omega2; }
+    const T* getMass(unsigned int beam) const { return beam == 0 ? mass1 : mass2; }
+    const T* getLength(unsigned int beam) const { return beam == 0 ? l1 : l2; }
+
+    // Per-pendulum energy drift relative to the initial energy, as in BasicDoublePendulumModel
+    T getEnergyDrift(unsigned int i) const { return std::fabs(energy[i] - initial_energy[i]) / energy_scale[i]; }
+    // Threshold on the drift of one step, pendulums above it re-integrate the step with substeps; <= 0 disables
+    T getDriftThreshold() const { return drift_threshold; }
+    void setDriftThreshold(T threshold) { drift_threshold = threshold; }
+    unsigned int getMaxSubsteps() const { return max_substeps; }
+    void setMaxSubsteps(unsigned int substeps) { max_substeps = substeps > 0 ? substeps : 1; }
+    unsigned long long countRefinedSteps() const { return refined_steps; }
+
+    // Recomputes initial energies, to be called after the state is changed from outside
+    void resetEnergy();
+
+    void saveSnapshot(Snapshot& snapshot) const;
+    void loadSnapshot(const Snapshot& snapshot);
+
+protected:
+    unsigned int count;
+    bool owns_state = true;
+
+    T* theta1 = nullptr;
+    T* omega1 = nullptr;
+    T* theta2 = nullptr;
+    T* omega2 = nullptr;
+
+    T* mass1 = nullptr;
+    T* l1 = nullptr;
+    T* mass2 = nullptr;
+    T* l2 = nullptr;
+
+    T* energy = nullptr;
+    T* initial_energy = nullptr;
+    T* energy_scale = nullptr;
+
+    T drift_threshold = T(1e-4);
+    unsigned int max_substeps = 64;
+    std::atomic<unsigned long long> refined_steps{ 0 };
+
+    T calculateEnergy(unsigned int i) const;
+
+private:
+    // One RK4 step of n lanes in place
+    static void stepLanes(T* th1, T* w1, T* th2, T* w2, const T* m1, const T* len1, const T* m2, const T* len2, unsigned int n, T h);
+    // Re-integrates one pendulum from y0 with growing number of substeps until its drift is below the threshold
+    void refineLane(unsigned int i, const T* y0, T step);
+    void allocateEnergy();
+};
+
+using PendulumEnsemble = BasicPendulumEnsemble<float>;
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cmath>
+
+#include "TaylorSeries.h"
+
+// Equations of the double pendulum shared by the single model and the ensemble.
+// Every scalar is of type T, so float evaluation never goes through double.
+
+template<typename T>
+struct PendulumConstants
+{
+    static constexpr T gravity = T(9.8);
+    static constexpr T pi = T(3.14159265358979323846264338327950288L);
+};
+
+template<typename T>
+constexpr T PendulumConstants<T>::gravity;
+
+template<typename T>
+constexpr T PendulumConstants<T>::pi;
+
+// Angular accelerations for theta 1, omega 1, theta 2, omega 2
+template<typename T>
+inline void pendulum_accelerations(T theta1, T w1, T theta2, T w2, T m1, T l1, T m2, T l2, T& dw1, T& dw2)
+{
+    const T g = PendulumConstants<T>::gravity;
+
+    const T M = m1 + m2;
+
+    const T delta = theta2 - theta1;
+    const T sin_d = std::sin(delta), cos_d = std::cos(delta);
+    const T sin1 = std::sin(theta1), sin2 = std::sin(theta2);
+
+    const T den = M * l1 - m2 * l1 * cos_d * cos_d;
+
+    dw1 = (m2 * l1 * w1 * w1 * sin_d * cos_d +
+           m2 * g * sin2 * cos_d +
+           m2 * l2 * w2 * w2 * sin_d -
+           M * g * sin1) / den;
+    dw2 = (-m2 * l2 * w2 * w2 * sin_d * cos_d +
+           M * g * sin1 * cos_d -
+           M * l1 * w1 * w1 * sin_d -
+           M * g * sin2) / (den * l2 / l1);
+}
+
+// Total energy from already evaluated trig terms of theta 1 and theta 2
+template<typename T>
+inline void pendulum_energy(T w1, T w2, T sin1, T cos1, T sin2, T cos2, T m1, T l1, T m2, T l2, T& kinetic, T& potential)
+{
+    const T g = PendulumConstants<T>::gravity;
+
+    const T M = m1 + m2;
+
+    const T cos_delta = cos2 * cos1 + sin2 * sin1;
+
+    kinetic = M * l1 * l1 * w1 * w1 / 2 +
+              m2 * l2 * l2 * w2 * w2 / 2 +
+              m2 * l1 * l2 * w1 * w2 * cos_delta;
+    potential = -M * g * l1 * cos1 -
+                 m2 * g * l2 * cos2;
+}
+
+// Normalized Taylor coefficients of the trajectory through y: the same equations as
+// pendulum_accelerations, expanded coefficient by coefficient with the recursions of TaylorSeries.h.
+// coeffs[i * (order + 1) + k] - k-th coefficient of y[i]
+template<typename T>
+void pendulum_taylor_coefficients(const T* y, unsigned int order, T* coeffs, T m1, T l1, T m2, T l2)
+{
+    if (order > max_taylor_order)
+        order = max_taylor_order;
+
+    const unsigned int n = max_taylor_order + 1;
+    const unsigned int stride = order + 1;
+
+    T* theta1 = coeffs;
+    T* w1 = coeffs + stride;
+    T* theta2 = coeffs + 2 * stride;
+    T* w2 = coeffs + 3 * stride;
+
+    T delta[n], sin1[n], cos1[n], sin2[n], cos2[n], sin_d[n], cos_d[n];
+    T w1_sq[n], w2_sq[n], sin_cos_d[n], cos_d_sq[n];
+    T num1[n], num2[n], den1[n], den2[n], dw1[n], dw2[n];
+
+    const T g = PendulumConstants<T>::gravity;
+
+    const T M = m1 + m2;
+
+    theta1[0] = y[0];
+    w1[0] = y[1];
+    theta2[0] = y[2];
+    w2[0] = y[3];
+
+    for (unsigned int k = 0; k < order; ++k)
+    {
+        delta[k] = theta2[k] - theta1[k];
+
+        taylor_sincos(theta1, sin1, cos1, k);
+        taylor_sincos(theta2, sin2, cos2, k);
+        taylor_sincos(delta, sin_d, cos_d, k);
+
+        w1_sq[k] = taylor_mul(w1, w1, k);
+        w2_sq[k] = taylor_mul(w2, w2, k);
+        sin_cos_d[k] = taylor_mul(sin_d, cos_d, k);
+        cos_d_sq[k] = taylor_mul(cos_d, cos_d, k);
+
+        den1[k] = (k == 0 ? M * l1 : T(0)) - m2 * l1 * cos_d_sq[k];
+        den2[k] = den1[k] * l2 / l1;
+
+        num1[k] = m2 * l1 * taylor_mul(w1_sq, sin_cos_d, k) +
+                  m2 * g * taylor_mul(sin2, cos_d, k) +
+                  m2 * l2 * taylor_mul(w2_sq, sin_d, k) -
+                  M * g * sin1[k];
+        num2[k] = -m2 * l2 * taylor_mul(w2_sq, sin_cos_d, k) +
+                  M * g * taylor_mul(sin1, cos_d, k) -
+                  M * l1 * taylor_mul(w1_sq, sin_d, k) -
+                  M * g * sin2[k];
+
+        dw1[k] = taylor_div(num1, den1, dw1, k);
+        dw2[k] = taylor_div(num2, den2, dw2, k);
+
+        theta1[k + 1] = w1[k] / (k + 1);
+        w1[k + 1] = dw1[k] / (k + 1);
+        theta2[k + 1] = w2[k] / (k + 1);
+        w2[k + 1] = dw2[k] / (k + 1);
+    }
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <list>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <vector>
+#include <utility>
+
+// History of a simulation advanced with a constant step, for rewinding and scrubbing.
+// Only every keyframe_interval-th frame is stored as a keyframe, any other frame is regenerated by
+// re-integration from the keyframe before it, which repeats the original steps exactly.
+// Regenerated segments of keyframe_interval frames are kept in a small LRU cache, so scrubbing back
+// and forth near one time costs no integration at all.
+//
+// Memory is bounded by max_keyframes + cached_segments * keyframe_interval snapshots: the oldest keyframes
+// are dropped and the earliest reachable frame moves forward. A seek integrates at most keyframe_interval - 1 steps.
+//
+// Model - BasicDoublePendulumModel or BasicPendulumEnsemble, anything with
+//         Snapshot, saveSnapshot, loadSnapshot and calculatePhysicalModel(T step)
+template<typename Model, typename T>
+class PendulumHistory
+{
+public:
+    using Snapshot = typename Model::Snapshot;
+    // Called after every step the model integrates, at the head and while regenerating segments
+    using StepCallback = std::function<void()>;
+
+public:
+    PendulumHistory(Model& p_model, T p_step, unsigned int p_keyframe_interval = 60, unsigned int p_max_keyframes = 600, unsigned int p_cached_segments = 4) :
+        model(p_model),
+        step(p_step),
+        keyframe_interval(p_keyframe_interval > 0 ? p_keyframe_interval : 1),
+        max_keyframes(p_max_keyframes > 0 ? p_max_keyframes : 1),
+        cached_segments(p_cached_segments)
+    {
+        keyframes.emplace_back();
+        model.saveSnapshot(keyframes.back());
+    }
+
+    // Current frame of the model, head frame and the earliest frame still reachable
+    unsigned long long getFrame() const { return frame; }
+    unsigned long long getHeadFrame() const { return head; }
+    unsigned long long getFirstFrame() const { return first_keyframe * keyframe_interval; }
+    T getStep() const { return step; }
+
+    // Loaded and replayed frames take no step and are not reported
+    void setStepCallback(StepCallback callback) { step_callback = callback; }
+
+    // Frames 0 .. count - 1 known in advance, e.g. served by TrajectoryCache, are loaded instead of integrated.
+    // The frames must stay valid while the history is used
+    void setPrecomputed(const Snapshot* frames, unsigned long long count)
+    {
+        precomputed = frames;
+        precomputed_count = frames ? count : 0;
+    }
+
+    // Next frame: replayed from the history behind the head, integrated and recorded at the head
+    void advance()
+    {
+        if (frame < head)
+        {
+            seek(frame + 1);
+            return;
+        }
+
+        if (head + 1 < precomputed_count)
+            model.loadSnapshot(precomputed[head + 1]);
+        else
+            integrateStep();
+        frame = ++head;
+
+        if (head % keyframe_interval == 0)
+            addKeyframe();
+    }
+
+    // Loads the frame into the model, clamped to the reachable frames; returns the frame loaded
+    unsigned long long seek(unsigned long long target)
+    {
+        if (target < getFirstFrame())
+            target = getFirstFrame();
+        if (target > head)
+            target = head;
+
+        const unsigned long long keyframe = target / keyframe_interval;
+        const unsigned long long offset = target % keyframe_interval;
+
+        if (target < precomputed_count)
+        {
+            model.loadSnapshot(precomputed[target]);
+        }
+        else if (offset == 0)
+        {
+            model.loadSnapshot(keyframes[keyframe - first_keyframe]);
+        }
+        else
+        {
+            Segment& segment = getSegment(keyframe, offset);
+            model.loadSnapshot(segment.snapshots[offset]);
+        }
+
+        frame = target;
+        return frame;
+    }
+
+protected:
+    struct Segment
+    {
+        unsigned long long keyframe = 0;
+        // Frames keyframe * keyframe_interval + i, the first one is the keyframe itself
+        std::vector<Snapshot> snapshots;
+    };
+
+    Model& model;
+    T step;
+
+    unsigned int keyframe_interval;
+    unsigned int max_keyframes;
+    unsigned int cached_segments;
+
+    unsigned long long frame = 0;
+    unsigned long long head = 0;
+
+    // Keyframe i of the deque is frame (first_keyframe + i) * keyframe_interval
+    std::deque<Snapshot> keyframes;
+    unsigned long long first_keyframe = 0;
+
+    // Most recently used segment first
+    std::list<Segment> cache;
+
+    const Snapshot* precomputed = nullptr;
+    unsigned long long precomputed_count = 0;
+
+    StepCallback step_callback;
+
+    void integrateStep()
+    {
+        model.calculatePhysicalModel(step);
+        if (step_callback)
+            step_callback();
+    }
+
+    void addKeyframe()
+    {
+        keyframes.emplace_back();
+        model.saveSnapshot(keyframes.back());
+
+        if (keyframes.size() > max_keyframes)
+        {
+            keyframes.pop_front();
+            ++first_keyframe;
+
+            cache.remove_if([this](const Segment& segment) { return segment.keyframe < first_keyframe; });
+        }
+    }
+
+    Segment& getSegment(unsigned long long keyframe, unsigned long long offset)
+    {
+        for (auto it = cache.begin(); it != cache.end(); ++it)
+        {
+            if (it->keyframe != keyframe)
+                continue;
+
+            // A segment regenerated near the head may be shorter than the frames recorded since
+            if (offset < it->snapshots.size())
+            {
+                cache.splice(cache.begin(), cache, it);
+                return cache.front();
+            }
+
+            cache.erase(it);
+            break;
+        }
+
+        Segment segment;
+        segment.keyframe = keyframe;
+
+        const unsigned long long first_frame = keyframe * keyframe_interval;
+        const unsigned long long last_frame = first_frame + keyframe_interval - 1 < head ? first_frame + keyframe_interval - 1 : head;
+
+        segment.snapshots.resize(last_frame - first_frame + 1);
+        segment.snapshots[0] = keyframes[keyframe - first_keyframe];
+
+        model.loadSnapshot(segment.snapshots[0]);
+        for (std::size_t i = 1; i < segment.snapshots.size(); ++i)
+        {
+            integrateStep();
+            model.saveSnapshot(segment.snapshots[i]);
+        }
+
+        cache.push_front(std::move(segment));
+        while (cache.size() > (cached_segments > 0 ? cached_segments : 1))
+            cache.pop_back();
+
+        return cache.front();
+    }
+};
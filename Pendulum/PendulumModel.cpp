@@ -0,0 +1,286 @@
+#include "PendulumModel.h"
+
+#include <type_traits>
+
+#include "SolverTaylor.h"
+
+template<typename T, typename E>
+BasicDoublePendulumModel<T, E>::BasicDoublePendulumModel(const T* mass_beams, const T* l_beams, const T* theta_beams, const T* omega_beams)
+{
+    const int num_beams = 2;
+
+    beams.reserve(num_beams);
+
+    for (int i = 0; i < num_beams; ++i)
+    {
+        beams.emplace_back(mass_beams[i], l_beams[i], theta_beams[i], omega_beams[i]);
+
+        if (i != 0)
+        {
+            beams[i].x += beams[i - 1].l * beams[i - 1].sin_theta;
+            beams[i].y -= beams[i - 1].l * beams[i - 1].cos_theta;
+        }
+    }
+
+    resetEnergy();
+}
+
+template<typename T, typename E>
+BasicDoublePendulumModel<T, E>::~BasicDoublePendulumModel()
+{
+    beams.clear();
+}
+
+template<typename T, typename E>
+void BasicDoublePendulumModel<T, E>::getState(T* y) const
+{
+    for (int i = 0; i < countBeams(); ++i)
+    {
+        y[2 * i] = beams[i].theta;
+        y[2 * i + 1] = beams[i].omega;
+    }
+}
+
+template<typename T, typename E>
+void BasicDoublePendulumModel<T, E>::setState(const T* y)
+{
+    T trig[4] = {};
+
+    for (int i = 0; i < countBeams(); ++i)
+    {
+        beams[i].theta = y[2 * i];
+        beams[i].omega = y[2 * i + 1];
+        beams[i].sin_theta = trig[2 * i] = std::sin(y[2 * i]);
+        beams[i].cos_theta = trig[2 * i + 1] = std::cos(y[2 * i]);
+    }
+
+    calculateEnergy(y, trig, energy);
+    energy_drift = std::fabs(energy.total - initial_energy.total) / energy_scale;
+
+    updateCoordinates();
+}
+
+template<typename T, typename E>
+void BasicDoublePendulumModel<T, E>::saveSnapshot(Snapshot& snapshot) const
+{
+    getState(snapshot.y);
+    snapshot.energy = energy;
+    snapshot.step_drift = step_drift;
+}
+
+template<typename T, typename E>
+void BasicDoublePendulumModel<T, E>::loadSnapshot(const Snapshot& snapshot)
+{
+    setState(snapshot.y);
+
+    // The energy of the step is kept as integrated, as the drift check of the next step compares against it
+    energy = snapshot.energy;
+    energy_drift = std::fabs(energy.total - initial_energy.total) / energy_scale;
+    step_drift = snapshot.step_drift;
+}
+
+template<typename T, typename E>
+void BasicDoublePendulumModel<T, E>::resetEnergy()
+{
+    T y[4] = { beams[0].theta, beams[0].omega, beams[1].theta, beams[1].omega };
+    T trig[4] = { beams[0].sin_theta, beams[0].cos_theta, beams[1].sin_theta, beams[1].cos_theta };
+    calculateEnergy(y, trig, initial_energy);
+    energy = initial_energy;
+    energy_drift = 0;
+    step_drift = 0;
+
+    // Drift is measured relative to the potential energy range, as the total energy itself may be zero
+    energy_scale = PendulumConstants<T>::gravity * ((beams[0].mass + beams[1].mass) * beams[0].l + beams[1].mass * beams[1].l);
+    if (std::fabs(initial_energy.total) > energy_scale)
+        energy_scale = std::fabs(initial_energy.total);
+}
+
+template<typename T, typename E>
+void BasicDoublePendulumModel<T, E>::updateCoordinates()
+{
+    for (int i = 0; i < countBeams(); ++i)
+    {
+        beams[i].x = beams[i].l * beams[i].sin_theta / 2;
+        beams[i].y = -beams[i].l * beams[i].cos_theta / 2;
+
+        if (i != 0)
+        {
+            beams[i].x += beams[i - 1].l * beams[i - 1].sin_theta;
+            beams[i].y -= beams[i - 1].l * beams[i - 1].cos_theta;
+        }
+    }
+}
+
+template<typename T, typename E>
+void BasicDoublePendulumModel<T, E>::calculateDerivates(const E* y_in, E* derivates) const
+{
+    // y_in
+    // 0 - theta 1
+    // 1 - omega 1
+    // 2 - theta 2
+    // 3 - omega 2
+
+    derivates[0] = y_in[1];
+    derivates[2] = y_in[3];
+
+    pendulum_accelerations<E>(y_in[0], y_in[1], y_in[2], y_in[3],
+                              (E)beams[0].mass, (E)beams[0].l, (E)beams[1].mass, (E)beams[1].l,
+                              derivates[1], derivates[3]);
+}
+
+template<typename T, typename E>
+void BasicDoublePendulumModel<T, E>::calculatePhysicalModel(T step)
+{
+    if (step <= 0)
+    {
+        std::cout << "Uncorrect step for calculations." << std::endl;
+        return;
+    }
+
+    const unsigned int size = 4;
+
+    // 0 - theta 1
+    // 1 - omega 1
+    // 2 - theta 2
+    // 3 - omega 2
+
+    T* y_in = new T[size] {};
+    T* y_out = new T[size] {};
+
+    getState(y_in);
+
+    // 0 - sin theta 1
+    // 1 - cos theta 1
+    // 2 - sin theta 2
+    // 3 - cos theta 2
+    T trig[4] = {};
+    BasicEnergy<T> step_energy;
+
+    // Re-integrate the interval at a finer step while the energy drift of this step is too large
+    unsigned int substeps = 1;
+    while (true)
+    {
+        integrate(y_in, y_out, step / substeps, substeps);
+
+        for (int i = 0; i < countBeams(); ++i)
+        {
+            trig[2 * i] = std::sin(y_out[2 * i]);
+            trig[2 * i + 1] = std::cos(y_out[2 * i]);
+        }
+        calculateEnergy(y_out, trig, step_energy);
+        step_drift = std::fabs(step_energy.total - energy.total) / energy_scale;
+
+        if (step_drift <= drift_threshold || substeps >= max_substeps)
+            break;
+
+        unsigned int factor = drift_policy ? drift_policy(*this, step_drift) : 2;
+        if (factor <= 1)
+            break;
+
+        substeps = substeps * factor < max_substeps ? substeps * factor : max_substeps;
+    }
+
+    if (substeps > 1)
+        ++refined_steps;
+    last_substeps = substeps;
+
+    energy = step_energy;
+    energy_drift = std::fabs(energy.total - initial_energy.total) / energy_scale;
+
+    // sin and cos of the rounded theta, as setState computes them for a frame loaded from a snapshot,
+    // so that a replayed frame is drawn at exactly the coordinates of the integrated one
+    const T two_pi = 2 * PendulumConstants<T>::pi;
+    for (int i = 0; i < countBeams(); ++i)
+    {
+        beams[i].theta = y_out[2 * i] - std::floor(y_out[2 * i] / two_pi) * two_pi; // Round theta in [0; 2*PI]
+        beams[i].omega = y_out[2 * i + 1];
+        beams[i].sin_theta = std::sin(beams[i].theta);
+        beams[i].cos_theta = std::cos(beams[i].theta);
+    }
+
+    delete[] y_in;
+    y_in = nullptr;
+
+    delete[] y_out;
+    y_out = nullptr;
+
+    updateCoordinates();
+}
+
+template<typename T, typename E>
+void BasicDoublePendulumModel<T, E>::integrate(const T* y_in, T* y_out, T step, unsigned int substeps)
+{
+    const unsigned int size = state_size;
+
+    T y_temp[size] = {};
+    for (unsigned int i = 0; i < size; ++i)
+        y_temp[i] = y_in[i];
+
+    if (method_id == SolverMethods::Taylor)
+    {
+        // Taylor coefficients are generated in at least double precision
+        using Wide = typename std::conditional<(sizeof(T) > sizeof(double)), T, double>::type;
+
+        typename SolverTaylor<Wide>::Coefficients func = [this](const Wide* y, unsigned int order, Wide* coeffs)
+        {
+            calculateTaylorCoefficients(y, order, coeffs);
+        };
+
+        SolverTaylor<Wide> solver;
+        solver.setTolerance(tolerance);
+
+        Wide y_wide[size] = {};
+        for (unsigned int i = 0; i < size; ++i)
+            y_wide[i] = y_in[i];
+
+        for (unsigned int i = 0; i < substeps; ++i)
+            solver.SolveTaylor(y_wide, func, y_wide, size, step);
+
+        for (unsigned int i = 0; i < size; ++i)
+            y_out[i] = (T)y_wide[i];
+
+        evaluations += solver.countEvaluations();
+        return;
+    }
+
+    typename BasicSolverODEs<T, E>::Derivates func = [this](const E* y, E* derivates)
+    {
+        calculateDerivates(y, derivates);
+    };
+
+    BasicSolverODEs<T, E> solver;
+    solver.setMethod(method_id == SolverMethods::RungeKutta45 ? SolverMethods::RungeKutta45 : SolverMethods::RungeKutta4);
+    solver.setStep(step);
+    solver.setTolerance(tolerance);
+
+    for (unsigned int i = 0; i < substeps; ++i)
+    {
+        if (solver.getMethod() == SolverMethods::RungeKutta45)
+            solver.SolveRK45(y_temp, func, y_out, size);
+        else
+            solver.SolveRK4(y_temp, func, y_out, size);
+
+        for (unsigned int j = 0; j < size; ++j)
+            y_temp[j] = y_out[j];
+    }
+
+    evaluations += solver.countEvaluations();
+}
+
+template<typename T, typename E>
+void BasicDoublePendulumModel<T, E>::calculateEnergy(const T* y, const T* trig, BasicEnergy<T>& result) const
+{
+    // Energy of the model integrated by calculateDerivates, built from already evaluated trig terms
+    // y    : theta 1, omega 1, theta 2, omega 2
+    // trig : sin theta 1, cos theta 1, sin theta 2, cos theta 2
+
+    pendulum_energy<T>(y[1], y[3], trig[0], trig[1], trig[2], trig[3],
+                       beams[0].mass, beams[0].l, beams[1].mass, beams[1].l,
+                       result.kinetic, result.potential);
+    result.total = result.kinetic + result.potential;
+}
+
+template class BasicDoublePendulumModel<float>;
+template class BasicDoublePendulumModel<double>;
+template class BasicDoublePendulumModel<double, float>;
+template class BasicDoublePendulumModel<long double>;
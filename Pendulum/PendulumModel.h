@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <iostream>
+#include <functional>
+
+#include "Solver.h"
+#include "PendulumEquations.h"
+
+template<typename T>
+struct BasicBeam
+{
+    BasicBeam(T p_mass = 1, T p_l = 1, T p_theta = PendulumConstants<T>::pi / 2, T p_omega = 0) :
+        x(0),
+        y(0),
+        z(0),
+        mass(p_mass),
+        l(p_l),
+        theta(p_theta),
+        omega(p_omega),
+        sin_theta(std::sin(p_theta)),
+        cos_theta(std::cos(p_theta))
+    {
+        x = l * sin_theta / 2;
+        y = -l * cos_theta / 2;
+    };
+
+    T x;
+    T y;
+    T z;
+
+    T mass;
+    T l;
+    T theta;
+    T omega;
+
+    // Trig terms of theta, evaluated once per step and shared by coordinates, vertices and energy
+    T sin_theta;
+    T cos_theta;
+};
+
+template<typename T>
+struct BasicEnergy
+{
+    T kinetic = 0;
+    T potential = 0;
+    T total = 0;
+};
+
+using Beam = BasicBeam<float>;
+using Energy = BasicEnergy<float>;
+
+// Physical model of the double pendulum without any rendering state.
+// T - scalar type of parameters and accumulated state
+// E - scalar type in which the derivates are evaluated
+template<typename T, typename E = T>
+class BasicDoublePendulumModel
+{
+public:
+    // Called when the energy drift of a step exceeds the threshold.
+    // Returns the factor by which the current substep is divided for re-integration (<= 1 accepts the step).
+    using DriftPolicy = std::function<unsigned int(const BasicDoublePendulumModel&, T step_drift)>;
+
+    static const unsigned int state_size = 4;
+
+    // Everything the next steps depend on: re-integration from a loaded snapshot repeats the original steps exactly
+    struct Snapshot
+    {
+        T y[state_size] = {};
+        BasicEnergy<T> energy;
+        T step_drift = 0;
+    };
+
+public:
+    BasicDoublePendulumModel(const T* mass_beams, const T* l_beams, const T* theta_beams, const T* omega_beams);
+    virtual ~BasicDoublePendulumModel();
+
+    virtual void calculatePhysicalModel(T step);
+
+    unsigned int countBeams() const { return beams.size(); }
+    const BasicBeam<T>& getBeam(unsigned int i) const { return beams[i]; }
+
+    // theta 1, omega 1, theta 2, omega 2
+    void getState(T* y) const;
+    void setState(const T* y);
+
+    void saveSnapshot(Snapshot& snapshot) const;
+    virtual void loadSnapshot(const Snapshot& snapshot);
+
+    void calculateDerivates(const E* y_in, E* derivates) const;
+    // Normalized Taylor coefficients of the trajectory through y, layout as in SolverTaylor
+    template<typename U>
+    void calculateTaylorCoefficients(const U* y, unsigned int order, U* coeffs) const
+    {
+        pendulum_taylor_coefficients<U>(y, order, coeffs, beams[0].mass, beams[0].l, beams[1].mass, beams[1].l);
+    }
+
+    SolverMethods::Method getMethod() const { return method_id; }
+    void setMethod(SolverMethods::Method method) { method_id = method; }
+    // Local error tolerance of the adaptive methods
+    T getTolerance() const { return tolerance; }
+    void setTolerance(T p_tolerance) { tolerance = p_tolerance; }
+    unsigned long long countEvaluations() const { return evaluations; }
+
+    const BasicEnergy<T>& getEnergy() const { return energy; }
+    const BasicEnergy<T>& getInitialEnergy() const { return initial_energy; }
+    T getEnergyDrift() const { return energy_drift; }
+    T getStepDrift() const { return step_drift; }
+
+    T getDriftThreshold() const { return drift_threshold; }
+    void setDriftThreshold(T threshold) { drift_threshold = threshold; }
+    unsigned int getMaxSubsteps() const { return max_substeps; }
+    void setMaxSubsteps(unsigned int substeps) { max_substeps = substeps > 0 ? substeps : 1; }
+    void setDriftPolicy(DriftPolicy policy) { drift_policy = policy; }
+    bool hasDriftPolicy() const { return static_cast<bool>(drift_policy); }
+
+    unsigned int getLastSubsteps() const { return last_substeps; }
+    unsigned long long countRefinedSteps() const { return refined_steps; }
+
+protected:
+
+    std::vector<BasicBeam<T>> beams;
+
+    SolverMethods::Method method_id = SolverMethods::RungeKutta4;
+    T tolerance = T(1e-6);
+    unsigned long long evaluations = 0;
+
+    BasicEnergy<T> energy;
+    BasicEnergy<T> initial_energy;
+    T energy_scale = 1;
+    T energy_drift = 0;
+    T step_drift = 0;
+
+    T drift_threshold = T(1e-4);
+    unsigned int max_substeps = 64;
+    DriftPolicy drift_policy;
+
+    unsigned int last_substeps = 1;
+    unsigned long long refined_steps = 0;
+
+    void updateCoordinates();
+    void resetEnergy();
+
+private:
+    void integrate(const T* y_in, T* y_out, T step, unsigned int substeps);
+    void calculateEnergy(const T* y, const T* trig, BasicEnergy<T>& result) const;
+};
+
+using DoublePendulumModel = BasicDoublePendulumModel<float>;
@@ -0,0 +1,331 @@
+#include "TrajectoryCache.h"
+
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <direct.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <dirent.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+namespace
+{
+    const char trajectory_magic[4] = { 'P', 'T', 'R', 'J' };
+    const uint32_t trajectory_version = 1;
+    // Frames start at this alignment, enough for any scalar type
+    const size_t frame_alignment = 16;
+
+    struct TrajectoryHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint32_t identity_size;
+        uint32_t frame_size;
+        uint64_t frames;
+    };
+
+    size_t align(size_t size)
+    {
+        return (size + frame_alignment - 1) / frame_alignment * frame_alignment;
+    }
+
+    struct StoredFile
+    {
+        std::string filename;
+        unsigned long long size;
+        long long modified;
+    };
+
+    // Trajectory files of the directory with their sizes and modification times
+    std::vector<StoredFile> list_files(const std::string& directory)
+    {
+        std::vector<StoredFile> files;
+
+#ifdef _WIN32
+        WIN32_FIND_DATAA data;
+        HANDLE find = FindFirstFileA((directory + "\\*.traj").c_str(), &data);
+        if (find == INVALID_HANDLE_VALUE)
+            return files;
+
+        do
+        {
+            ULARGE_INTEGER size, modified;
+            size.LowPart = data.nFileSizeLow;
+            size.HighPart = data.nFileSizeHigh;
+            modified.LowPart = data.ftLastWriteTime.dwLowDateTime;
+            modified.HighPart = data.ftLastWriteTime.dwHighDateTime;
+
+            files.push_back({ directory + "\\" + data.cFileName, size.QuadPart, (long long)modified.QuadPart });
+        } while (FindNextFileA(find, &data));
+
+        FindClose(find);
+#else
+        DIR* dir = opendir(directory.c_str());
+        if (!dir)
+            return files;
+
+        while (dirent* entry = readdir(dir))
+        {
+            const std::string name = entry->d_name;
+            if (name.size() < 5 || name.compare(name.size() - 5, 5, ".traj") != 0)
+                continue;
+
+            struct stat status;
+            const std::string filename = directory + "/" + name;
+            if (stat(filename.c_str(), &status) == 0)
+            {
+                // Nanoseconds, hits within one second must still be ordered
+#ifdef __APPLE__
+                const long long modified = (long long)status.st_mtimespec.tv_sec * 1000000000ll + status.st_mtimespec.tv_nsec;
+#else
+                const long long modified = (long long)status.st_mtim.tv_sec * 1000000000ll + status.st_mtim.tv_nsec;
+#endif
+                files.push_back({ filename, (unsigned long long)status.st_size, modified });
+            }
+        }
+
+        closedir(dir);
+#endif
+
+        return files;
+    }
+
+    // Sets the modification time to now while the file may be mapped. On Windows the mapping handle does not
+    // share writing, a handle with attribute access only is not subject to sharing and may set the time
+    bool touch_file(const std::string& filename)
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filename.c_str(), FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        FILETIME now;
+        GetSystemTimeAsFileTime(&now);
+        const bool touched = SetFileTime(file, nullptr, nullptr, &now) != 0;
+
+        CloseHandle(file);
+        return touched;
+#else
+        return utimensat(AT_FDCWD, filename.c_str(), nullptr, 0) == 0;
+#endif
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    file_handle = file;
+    mapping_handle = mapping;
+    data = static_cast<const unsigned char*>(view);
+    size = (size_t)file_size.QuadPart;
+#else
+    int file = ::open(filename.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    void* view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    // The mapping stays valid after the descriptor is closed
+    ::close(file);
+    if (view == MAP_FAILED)
+        return false;
+
+    data = static_cast<const unsigned char*>(view);
+    size = (size_t)status.st_size;
+#endif
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping_handle);
+    CloseHandle(file_handle);
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(data), size);
+#endif
+
+    data = nullptr;
+    size = 0;
+}
+
+TrajectoryStore::TrajectoryStore(const std::string& p_directory, unsigned long long p_max_bytes) :
+    directory(p_directory),
+    max_bytes(p_max_bytes)
+{
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+}
+
+std::string TrajectoryStore::getFilename(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.traj", (unsigned long long)key);
+
+#ifdef _WIN32
+    return directory + "\\" + name;
+#else
+    return directory + "/" + name;
+#endif
+}
+
+bool TrajectoryStore::find(uint64_t key, const std::vector<unsigned char>& identity, size_t frame_size, unsigned long long frames,
+                           MappedFile& file, const unsigned char*& first_frame)
+{
+    const std::string filename = getFilename(key);
+
+    if (file.open(filename))
+    {
+        TrajectoryHeader header;
+        const size_t frames_offset = align(sizeof(header) + identity.size());
+
+        if (file.getSize() >= frames_offset)
+            std::memcpy(&header, file.getData(), sizeof(header));
+
+        const bool match = file.getSize() >= frames_offset
+            && std::memcmp(header.magic, trajectory_magic, sizeof(trajectory_magic)) == 0
+            && header.version == trajectory_version
+            && header.key == key
+            && header.identity_size == identity.size()
+            && header.frame_size == frame_size
+            && header.frames >= frames
+            && file.getSize() >= frames_offset + header.frames * frame_size
+            && std::memcmp(file.getData() + sizeof(header), identity.data(), identity.size()) == 0;
+
+        if (match)
+        {
+            // Refreshes the position of the entry in the LRU order
+            if (!touch_file(filename))
+                std::cout << "Failed to refresh the time of " << filename << ", it may be evicted early" << std::endl;
+
+            first_frame = file.getData() + frames_offset;
+            return true;
+        }
+
+        file.close();
+    }
+
+    return false;
+}
+
+bool TrajectoryStore::store(uint64_t key, const std::vector<unsigned char>& identity, size_t frame_size, unsigned long long frames, const void* frame_data)
+{
+    const std::string filename = getFilename(key);
+
+    // Unique name, so that processes storing the same key do not write into one file
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), ".%llx.tmp", (unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count());
+    const std::string temp_filename = filename + suffix;
+
+    std::ofstream out(temp_filename, std::ios::binary);
+    if (!out)
+    {
+        std::cout << "Failed to open " << temp_filename << std::endl;
+        return false;
+    }
+
+    TrajectoryHeader header;
+    std::memcpy(header.magic, trajectory_magic, sizeof(trajectory_magic));
+    header.version = trajectory_version;
+    header.key = key;
+    header.identity_size = (uint32_t)identity.size();
+    header.frame_size = (uint32_t)frame_size;
+    header.frames = frames;
+
+    const std::vector<unsigned char> padding(align(sizeof(header) + identity.size()) - sizeof(header) - identity.size(), 0);
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(identity.data()), identity.size());
+    out.write(reinterpret_cast<const char*>(padding.data()), padding.size());
+    out.write(static_cast<const char*>(frame_data), frame_size * frames);
+    out.close();
+
+    const bool written = !out.fail();
+
+    std::remove(filename.c_str());
+    if (!written || std::rename(temp_filename.c_str(), filename.c_str()) != 0)
+    {
+        std::remove(temp_filename.c_str());
+        return false;
+    }
+
+    evict();
+    return true;
+}
+
+void TrajectoryStore::evict()
+{
+    std::vector<StoredFile> files = list_files(directory);
+
+    unsigned long long total = 0;
+    for (auto& file : files)
+        total += file.size;
+
+    std::sort(files.begin(), files.end(), [](const StoredFile& a, const StoredFile& b) { return a.modified < b.modified; });
+
+    // Files still mapped by another process may fail to be removed, they are left for the next eviction
+    for (size_t i = 0; i < files.size() && total > max_bytes; ++i)
+    {
+        if (std::remove(files[i].filename.c_str()) == 0)
+            total -= files[i].size;
+    }
+}
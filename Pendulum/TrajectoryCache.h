@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#include "PendulumModel.h"
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    const unsigned char* getData() const { return data; }
+    size_t getSize() const { return size; }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+};
+
+// Directory of content-addressed trajectory files, one per key, limited to max_bytes in total.
+// Least recently used files (by modification time, refreshed on every hit) are removed first.
+// An entry is served only when its identity - the exact bytes it was computed from - matches,
+// so a key collision or a quantization step too coarse costs a recomputation, never a wrong trajectory.
+class TrajectoryStore
+{
+public:
+    TrajectoryStore(const std::string& directory, unsigned long long max_bytes = 256ull << 20);
+
+    const std::string& getDirectory() const { return directory; }
+    unsigned long long getMaxBytes() const { return max_bytes; }
+
+    // Maps the entry if it holds at least frames frames of frame_size bytes, first_frame points into the mapping
+    bool find(uint64_t key, const std::vector<unsigned char>& identity, size_t frame_size, unsigned long long frames,
+              MappedFile& file, const unsigned char*& first_frame);
+    bool store(uint64_t key, const std::vector<unsigned char>& identity, size_t frame_size, unsigned long long frames, const void* data);
+
+    unsigned long long countHits() const { return hits; }
+    unsigned long long countMisses() const { return misses; }
+
+protected:
+    std::string directory;
+    unsigned long long max_bytes;
+
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+
+    std::string getFilename(uint64_t key) const;
+    void evict();
+};
+
+// Trajectories of BasicDoublePendulumModel: the snapshots of frames 0, 1, ... advanced by calculatePhysicalModel(step)
+// from the current state of the model. The key hashes the parameters, state, method and step quantized to quantum,
+// the identity holds them exactly, so that a served trajectory is the one the model would integrate bit for bit.
+template<typename T, typename E = T>
+class BasicTrajectoryCache : public TrajectoryStore
+{
+public:
+    using Model = BasicDoublePendulumModel<T, E>;
+    using Snapshot = typename Model::Snapshot;
+
+    struct Trajectory
+    {
+        MappedFile file;
+        // Frames in the mapping, or in computed if the trajectory could not be stored
+        std::vector<Snapshot> computed;
+        const Snapshot* frames = nullptr;
+        unsigned long long count = 0;
+        bool hit = false;
+    };
+
+public:
+    BasicTrajectoryCache(const std::string& p_directory, unsigned long long p_max_bytes = 256ull << 20, double p_quantum = 1e-9) :
+        TrajectoryStore(p_directory, p_max_bytes),
+        quantum(p_quantum)
+    {
+    }
+
+    // Serves count frames from the disk, or integrates them on a copy of the model and stores them.
+    // Models with a drift policy or a non-finite value are integrated every time, as they cannot be keyed.
+    bool getTrajectory(const Model& model, T step, unsigned long long count, Trajectory& trajectory)
+    {
+        trajectory.file.close();
+        trajectory.computed.clear();
+        trajectory.frames = nullptr;
+        trajectory.count = 0;
+        trajectory.hit = false;
+
+        if (count == 0)
+            return false;
+
+        std::vector<unsigned char> identity;
+        uint64_t key = 0;
+        const bool keyed = !model.hasDriftPolicy() && makeKey(model, step, key, identity);
+        const unsigned char* first_frame = nullptr;
+
+        if (keyed && find(key, identity, sizeof(Snapshot), count, trajectory.file, first_frame))
+        {
+            ++hits;
+            trajectory.frames = reinterpret_cast<const Snapshot*>(first_frame);
+            trajectory.count = count;
+            trajectory.hit = true;
+            return true;
+        }
+
+        ++misses;
+
+        Model copy(model);
+        trajectory.computed.resize(count);
+        copy.saveSnapshot(trajectory.computed[0]);
+        for (unsigned long long i = 1; i < count; ++i)
+        {
+            copy.calculatePhysicalModel(step);
+            copy.saveSnapshot(trajectory.computed[i]);
+        }
+
+        // Served from the mapping like a hit once stored, the computed copy is dropped
+        if (keyed && store(key, identity, sizeof(Snapshot), count, trajectory.computed.data())
+            && find(key, identity, sizeof(Snapshot), count, trajectory.file, first_frame))
+        {
+            trajectory.computed.clear();
+            trajectory.computed.shrink_to_fit();
+            trajectory.frames = reinterpret_cast<const Snapshot*>(first_frame);
+        }
+        else
+        {
+            trajectory.frames = trajectory.computed.data();
+        }
+
+        trajectory.count = count;
+        return true;
+    }
+
+protected:
+    double quantum;
+
+    template<typename U>
+    static void append(std::vector<unsigned char>& bytes, const U& value)
+    {
+        const unsigned char* begin = reinterpret_cast<const unsigned char*>(&value);
+        bytes.insert(bytes.end(), begin, begin + sizeof(U));
+    }
+
+    // False if a value is not finite
+    bool makeKey(const Model& model, T step, uint64_t& key, std::vector<unsigned char>& identity) const
+    {
+        Snapshot initial;
+        model.saveSnapshot(initial);
+
+        // Everything the steps depend on, see BasicDoublePendulumModel::calculatePhysicalModel
+        const T values[] = {
+            model.getBeam(0).mass, model.getBeam(0).l, model.getBeam(1).mass, model.getBeam(1).l,
+            initial.y[0], initial.y[1], initial.y[2], initial.y[3],
+            initial.energy.kinetic, initial.energy.potential, initial.energy.total, initial.step_drift,
+            model.getInitialEnergy().total, step, model.getTolerance(), model.getDriftThreshold()
+        };
+        const uint32_t settings[] = { (uint32_t)sizeof(T), (uint32_t)sizeof(E), (uint32_t)model.getMethod(), model.getMaxSubsteps() };
+
+        for (const T& value : values)
+        {
+            if (!std::isfinite(value))
+                return false;
+        }
+
+        identity.clear();
+        for (const T& value : values)
+            append(identity, value);
+        for (uint32_t setting : settings)
+            append(identity, setting);
+
+        // FNV-1a over the settings and the values rounded to the quantum
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](uint64_t word)
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                hash ^= (word >> (8 * i)) & 0xff;
+                hash *= 1099511628211ull;
+            }
+        };
+
+        for (uint32_t setting : settings)
+            mix(setting);
+        // Quotients beyond the range of long long are hashed by the bits of the value instead
+        for (const T& value : values)
+        {
+            const double quotient = (double)value / quantum;
+            if (std::fabs(quotient) < 9.0e18)
+            {
+                mix((uint64_t)std::llround(quotient));
+            }
+            else
+            {
+                uint64_t bits;
+                const double exact = (double)value;
+                std::memcpy(&bits, &exact, sizeof(bits));
+                mix(bits);
+            }
+        }
+
+        key = hash;
+        return true;
+    }
+};
+
+using TrajectoryCache = BasicTrajectoryCache<float>;
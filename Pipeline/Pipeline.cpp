@@ -0,0 +1,283 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "TaskGraph.h"
+#include "PendulumEnsemble.h"
+
+// Usage:
+//   Pipeline [--pendulums N] [--frames F] [--steps S] [--capture C] [--threads T] [--capacity Q] [--out prefix]
+//
+// Integrates an ensemble of N double pendulums for F frames of 1/60 s (S steps each) and runs four stages over one thread pool:
+//   integration - steps the ensemble in parallel chunks and publishes every frame
+//   statistics  - mean and max energy drift of every frame into prefix_stats.csv
+//   trajectory  - every frame into prefix.traj
+//   capture     - every C-th frame drawn into prefix_NNNNNN.pgm
+// The stages are connected by channels of Q frames: while the consumers keep up, writing and drawing frame k overlap
+// with the integration of the next frames; a slow consumer fills its channel and suspends the integration.
+
+using Ensemble = PendulumEnsemble;
+using Scalar = float;
+
+struct Options
+{
+    unsigned int pendulums = 4096;
+    unsigned int frames = 600;
+    unsigned int steps = 10;
+    unsigned int capture = 60;
+    unsigned int threads = 0;
+    unsigned int capacity = 4;
+    std::string prefix = "pipeline";
+};
+
+// One published frame, shared read-only by all consumers
+struct Frame
+{
+    unsigned int index = 0;
+    // theta 1, omega 1, theta 2, omega 2 and energy, array after array as in BasicPendulumEnsemble::Snapshot
+    Ensemble::Snapshot state;
+    std::vector<Scalar> drift;
+};
+
+using FramePtr = std::shared_ptr<const Frame>;
+
+// Time a stage spent working, not waiting in channels
+struct StageTime
+{
+    const char* name;
+    double seconds = 0.0;
+};
+
+class StageTimer
+{
+public:
+    explicit StageTimer(StageTime& p_time) : time(p_time), start(std::chrono::steady_clock::now()) {}
+    ~StageTimer() { time.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+
+private:
+    StageTime& time;
+    std::chrono::steady_clock::time_point start;
+};
+
+static Task<> integrate(ThreadPool& pool, Ensemble& ensemble, const Options& options, std::vector<Channel<FramePtr>*> outputs, StageTime& time)
+{
+    const Scalar step = Scalar(1) / (60 * options.steps);
+    const unsigned int count = ensemble.countPendulums();
+    // Enough chunks for every thread, each a multiple of the ensemble block
+    const unsigned int chunk = ((count / pool.countThreads() + Ensemble::block_size - 1) / Ensemble::block_size) * Ensemble::block_size;
+
+    for (unsigned int index = 0; index < options.frames; ++index)
+    {
+        auto frame = std::make_shared<Frame>();
+        {
+            StageTimer timer(time);
+
+            if (index > 0)
+            {
+                co_await parallel_for(pool, 0, count, chunk, [&](unsigned int begin, unsigned int end)
+                {
+                    ensemble.calculatePhysicalModel(step, options.steps, begin, end);
+                });
+            }
+
+            frame->index = index;
+            ensemble.saveSnapshot(frame->state);
+            frame->drift.resize(count);
+            for (unsigned int i = 0; i < count; ++i)
+                frame->drift[i] = ensemble.getEnergyDrift(i);
+        }
+
+        FramePtr shared = std::move(frame);
+        for (Channel<FramePtr>* output : outputs)
+            co_await output->send(shared);
+    }
+
+    for (Channel<FramePtr>* output : outputs)
+        output->close();
+}
+
+static Task<> collect_statistics(Channel<FramePtr>& input, const Options& options, StageTime& time)
+{
+    std::ofstream out(options.prefix + "_stats.csv");
+    out << "frame,time,mean_drift,max_drift\n" << std::setprecision(9);
+
+    while (std::optional<FramePtr> frame = co_await input.receive())
+    {
+        StageTimer timer(time);
+
+        double sum = 0.0, max = 0.0;
+        for (Scalar drift : (*frame)->drift)
+        {
+            sum += drift;
+            max = drift > max ? drift : max;
+        }
+
+        const double mean = (*frame)->drift.empty() ? 0.0 : sum / (*frame)->drift.size();
+        out << (*frame)->index << "," << (*frame)->index / 60.0 << "," << mean << "," << max << "\n";
+    }
+
+    if (!out)
+        std::cout << "Failed to write " << options.prefix << "_stats.csv" << std::endl;
+}
+
+// prefix.traj: "PPTR", uint32 pendulum count, uint32 scalar size, then per frame uint32 index and the Frame::state array
+static Task<> write_trajectory(Channel<FramePtr>& input, unsigned int count, const Options& options, StageTime& time)
+{
+    std::ofstream out(options.prefix + ".traj", std::ios::binary);
+    const uint32_t header[] = { count, (uint32_t)sizeof(Scalar) };
+    out.write("PPTR", 4);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    while (std::optional<FramePtr> frame = co_await input.receive())
+    {
+        StageTimer timer(time);
+
+        const uint32_t index = (*frame)->index;
+        out.write(reinterpret_cast<const char*>(&index), sizeof(index));
+        out.write(reinterpret_cast<const char*>((*frame)->state.data()), (*frame)->state.size() * sizeof(Scalar));
+    }
+
+    if (!out)
+        std::cout << "Failed to write " << options.prefix << ".traj" << std::endl;
+}
+
+// Lower beams of all pendulums as a grey-scale image: every pixel counts the bobs on it
+static Task<> capture_frames(Channel<FramePtr>& input, const Ensemble& ensemble, const Options& options, StageTime& time)
+{
+    const unsigned int size = 512;
+    const unsigned int count = ensemble.countPendulums();
+
+    while (std::optional<FramePtr> frame = co_await input.receive())
+    {
+        if (options.capture == 0 || (*frame)->index % options.capture != 0)
+            continue;
+
+        StageTimer timer(time);
+
+        const Scalar* theta1 = (*frame)->state.data();
+        const Scalar* theta2 = theta1 + 2 * size_t(count);
+
+        std::vector<unsigned char> pixels(size * size, 255);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            const Scalar l1 = ensemble.getLength(0)[i], l2 = ensemble.getLength(1)[i];
+            const Scalar reach = l1 + l2;
+            const Scalar x = (l1 * std::sin(theta1[i]) + l2 * std::sin(theta2[i])) / reach;
+            const Scalar y = (-l1 * std::cos(theta1[i]) - l2 * std::cos(theta2[i])) / reach;
+
+            const int px = (int)((x * 0.5f + 0.5f) * (size - 1));
+            const int py = (int)((0.5f - y * 0.5f) * (size - 1));
+            if (px >= 0 && py >= 0 && px < (int)size && py < (int)size)
+            {
+                unsigned char& pixel = pixels[py * size + px];
+                pixel = pixel > 64 ? pixel - 64 : 0;
+            }
+        }
+
+        char filename[32];
+        std::snprintf(filename, sizeof(filename), "_%06u.pgm", (*frame)->index);
+
+        std::ofstream out(options.prefix + filename, std::ios::binary);
+        out << "P5\n" << size << " " << size << "\n255\n";
+        out.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+
+        if (!out)
+            std::cout << "Failed to write " << options.prefix << filename << std::endl;
+    }
+}
+
+static bool parse_options(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool has_value = i + 1 < argc;
+
+        if (std::strcmp(argv[i], "--out") == 0 && has_value)
+        {
+            options.prefix = argv[++i];
+            continue;
+        }
+
+        unsigned int* value = nullptr;
+        if (std::strcmp(argv[i], "--pendulums") == 0)
+            value = &options.pendulums;
+        else if (std::strcmp(argv[i], "--frames") == 0)
+            value = &options.frames;
+        else if (std::strcmp(argv[i], "--steps") == 0)
+            value = &options.steps;
+        else if (std::strcmp(argv[i], "--capture") == 0)
+            value = &options.capture;
+        else if (std::strcmp(argv[i], "--threads") == 0)
+            value = &options.threads;
+        else if (std::strcmp(argv[i], "--capacity") == 0)
+            value = &options.capacity;
+
+        if (!value || !has_value)
+        {
+            std::cout << "Unknown or incomplete option " << argv[i] << std::endl;
+            return false;
+        }
+
+        *value = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+    }
+
+    if (options.pendulums == 0 || options.steps == 0)
+    {
+        std::cout << "--pendulums and --steps must be positive" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+        return 1;
+
+    // Nearly equal initial conditions, the chaotic motion spreads them apart
+    Ensemble ensemble(options.pendulums);
+    for (unsigned int i = 0; i < options.pendulums; ++i)
+    {
+        const Scalar mass[2] = { 0.6f, 0.6f }, l[2] = { 0.4f, 0.4f };
+        const Scalar theta[2] = { 2.0f + 1e-4f * i / options.pendulums, 2.0f }, omega[2] = { 0.0f, 0.0f };
+        ensemble.setPendulum(i, mass, l, theta, omega);
+    }
+    ensemble.resetEnergy();
+
+    ThreadPool pool(options.threads);
+
+    Channel<FramePtr> statistics(pool, options.capacity);
+    Channel<FramePtr> trajectory(pool, options.capacity);
+    Channel<FramePtr> capture(pool, options.capacity);
+
+    StageTime integration_time{ "integration" }, statistics_time{ "statistics" }, trajectory_time{ "trajectory" }, capture_time{ "capture" };
+
+    std::vector<Task<>> tasks;
+    tasks.push_back(integrate(pool, ensemble, options, { &statistics, &trajectory, &capture }, integration_time));
+    tasks.push_back(collect_statistics(statistics, options, statistics_time));
+    tasks.push_back(write_trajectory(trajectory, options.pendulums, options, trajectory_time));
+    tasks.push_back(capture_frames(capture, ensemble, options, capture_time));
+
+    const auto start = std::chrono::steady_clock::now();
+    run_tasks(pool, tasks);
+    const double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << options.pendulums << " pendulums, " << options.frames << " frames on " << pool.countThreads() << " threads: "
+              << total << " s" << std::endl;
+    // Stage times adding up to more than the total is the overlap gained
+    for (const StageTime* stage : { &integration_time, &statistics_time, &trajectory_time, &capture_time })
+        std::cout << "  " << stage->name << ": " << stage->seconds << " s" << std::endl;
+
+    return 0;
+}
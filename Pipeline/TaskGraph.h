@@ -0,0 +1,408 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <optional>
+#include <utility>
+#include <exception>
+#include <coroutine>
+#include <condition_variable>
+
+#include "ThreadPool.h"
+
+// Stages of a processing graph written as C++20 coroutines over one ThreadPool.
+//
+// Task<T>       - lazily started coroutine returning T, started by co_await
+// schedule      - co_await schedule(pool) continues the coroutine on a thread of the pool
+// parallel_for  - co_await parallel_for(pool, begin, end, chunk, fn) runs fn(first, last) over chunks on the pool
+// Channel<T>    - bounded queue between stages: send suspends the producer while the channel is full
+//                 (back-pressure), receive suspends the consumer while it is empty, no thread is blocked
+// run_tasks     - blocks the calling thread until all tasks have finished on the pool
+//
+// Suspended coroutines are always resumed through the pool, never inside a channel lock.
+
+template<typename T = void>
+class Task;
+
+namespace task_graph
+{
+    struct FinalAwaiter
+    {
+        bool await_ready() noexcept { return false; }
+
+        // Resumes whoever awaited the task, symmetric transfer keeps long chains off the stack
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    struct PromiseBase
+    {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr exception;
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    template<typename T>
+    struct Promise : PromiseBase
+    {
+        std::optional<T> value;
+
+        Task<T> get_return_object();
+        void return_value(T result) { value = std::move(result); }
+
+        T getResult()
+        {
+            if (exception)
+                std::rethrow_exception(exception);
+            return std::move(*value);
+        }
+    };
+
+    template<>
+    struct Promise<void> : PromiseBase
+    {
+        Task<void> get_return_object();
+        void return_void() {}
+
+        void getResult()
+        {
+            if (exception)
+                std::rethrow_exception(exception);
+        }
+    };
+}
+
+template<typename T>
+class [[nodiscard]] Task
+{
+public:
+    using promise_type = task_graph::Promise<T>;
+
+public:
+    explicit Task(std::coroutine_handle<promise_type> p_handle) : handle(p_handle) {}
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    ~Task()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume() { return handle.promise().getResult(); }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+namespace task_graph
+{
+    template<typename T>
+    Task<T> Promise<T>::get_return_object()
+    {
+        return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+    }
+
+    inline Task<void> Promise<void>::get_return_object()
+    {
+        return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+    }
+
+    // Starts eagerly and destroys itself when done, used by run_tasks only
+    struct Detached
+    {
+        struct promise_type
+        {
+            Detached get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+}
+
+inline auto schedule(ThreadPool& pool)
+{
+    struct ScheduleAwaiter
+    {
+        ThreadPool& pool;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { pool.post([handle]() { handle.resume(); }); }
+        void await_resume() const noexcept {}
+    };
+
+    return ScheduleAwaiter{ pool };
+}
+
+// fn(first, last) for the chunks of [begin, end), the awaiting coroutine continues on the thread finishing the last chunk.
+// fn must not throw
+template<typename F>
+auto parallel_for(ThreadPool& pool, unsigned int begin, unsigned int end, unsigned int chunk, F fn)
+{
+    struct ParallelAwaiter
+    {
+        ThreadPool& pool;
+        unsigned int begin;
+        unsigned int end;
+        unsigned int chunk;
+        F fn;
+        std::atomic<unsigned int> remaining{ 0 };
+        std::coroutine_handle<> continuation{};
+
+        bool await_ready() const noexcept { return begin >= end; }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            continuation = handle;
+
+            const unsigned int chunks = (end - begin + chunk - 1) / chunk;
+            remaining = chunks;
+
+            for (unsigned int i = 0; i < chunks; ++i)
+            {
+                const unsigned int first = begin + i * chunk;
+                const unsigned int last = end - first > chunk ? first + chunk : end;
+
+                pool.post([this, first, last]()
+                {
+                    fn(first, last);
+                    if (--remaining == 0)
+                        continuation.resume();
+                });
+            }
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    return ParallelAwaiter{ pool, begin, end, chunk > 0 ? chunk : 1, std::move(fn) };
+}
+
+template<typename T>
+class Channel
+{
+public:
+    Channel(ThreadPool& p_pool, size_t p_capacity) :
+        pool(p_pool),
+        capacity(p_capacity > 0 ? p_capacity : 1)
+    {
+    }
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    class SendAwaiter
+    {
+    public:
+        SendAwaiter(Channel& p_channel, T p_value) : channel(p_channel), value(std::move(p_value)) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            this->handle = handle;
+            return channel.suspendSend(*this);
+        }
+
+        // false if the channel was closed and the value dropped
+        bool await_resume() const noexcept { return sent; }
+
+    private:
+        friend class Channel;
+
+        Channel& channel;
+        T value;
+        bool sent = false;
+        std::coroutine_handle<> handle;
+    };
+
+    class ReceiveAwaiter
+    {
+    public:
+        explicit ReceiveAwaiter(Channel& p_channel) : channel(p_channel) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            this->handle = handle;
+            return channel.suspendReceive(*this);
+        }
+
+        // Empty once the channel is closed and drained
+        std::optional<T> await_resume() { return std::move(value); }
+
+    private:
+        friend class Channel;
+
+        Channel& channel;
+        std::optional<T> value;
+        std::coroutine_handle<> handle;
+    };
+
+    SendAwaiter send(T value) { return SendAwaiter(*this, std::move(value)); }
+    ReceiveAwaiter receive() { return ReceiveAwaiter(*this); }
+
+    // Receivers get the values still queued, then nothing; suspended senders are resumed with false
+    void close()
+    {
+        std::vector<std::coroutine_handle<>> resumed;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+
+            for (SendAwaiter* sender : senders)
+                resumed.push_back(sender->handle);
+            for (ReceiveAwaiter* receiver : receivers)
+                resumed.push_back(receiver->handle);
+
+            senders.clear();
+            receivers.clear();
+        }
+
+        for (auto handle : resumed)
+            resume(handle);
+    }
+
+private:
+    ThreadPool& pool;
+    size_t capacity;
+
+    std::mutex mutex;
+    std::deque<T> items;
+    std::deque<SendAwaiter*> senders;
+    std::deque<ReceiveAwaiter*> receivers;
+    bool closed = false;
+
+    void resume(std::coroutine_handle<> handle)
+    {
+        pool.post([handle]() { handle.resume(); });
+    }
+
+    // Returns whether the sender stays suspended
+    bool suspendSend(SendAwaiter& sender)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (closed)
+            return false;
+
+        // Straight to a waiting receiver, the channel is empty then
+        if (!receivers.empty())
+        {
+            ReceiveAwaiter* receiver = receivers.front();
+            receivers.pop_front();
+            receiver->value = std::move(sender.value);
+            sender.sent = true;
+
+            lock.unlock();
+            resume(receiver->handle);
+            return false;
+        }
+
+        if (items.size() < capacity)
+        {
+            items.push_back(std::move(sender.value));
+            sender.sent = true;
+            return false;
+        }
+
+        // Full: the value is taken by a receiver making room
+        senders.push_back(&sender);
+        return true;
+    }
+
+    // Returns whether the receiver stays suspended
+    bool suspendReceive(ReceiveAwaiter& receiver)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (!items.empty())
+        {
+            receiver.value = std::move(items.front());
+            items.pop_front();
+
+            // Room for the first suspended sender
+            if (!senders.empty())
+            {
+                SendAwaiter* sender = senders.front();
+                senders.pop_front();
+                items.push_back(std::move(sender->value));
+                sender->sent = true;
+
+                lock.unlock();
+                resume(sender->handle);
+            }
+
+            return false;
+        }
+
+        if (closed)
+            return false;
+
+        receivers.push_back(&receiver);
+        return true;
+    }
+};
+
+// Starts every task on the pool and waits for all of them, rethrows the first exception of a task
+inline void run_tasks(ThreadPool& pool, std::vector<Task<void>>& tasks)
+{
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t remaining = tasks.size();
+    std::exception_ptr exception;
+
+    auto run = [&](Task<void>& task) -> task_graph::Detached
+    {
+        co_await schedule(pool);
+
+        std::exception_ptr error;
+        try
+        {
+            co_await task;
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error && !exception)
+            exception = error;
+        if (--remaining == 0)
+            done.notify_one();
+    };
+
+    for (auto& task : tasks)
+        run(task);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return remaining == 0; });
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
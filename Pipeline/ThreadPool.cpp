@@ -0,0 +1,54 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int count)
+{
+    if (count == 0)
+        count = std::thread::hardware_concurrency();
+    if (count == 0)
+        count = 1;
+
+    for (unsigned int i = 0; i < count; ++i)
+        threads.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void ThreadPool::post(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    ready.notify_one();
+}
+
+void ThreadPool::work()
+{
+    for (;;)
+    {
+        std::function<void()> job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+            if (jobs.empty())
+                return;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        job();
+    }
+}
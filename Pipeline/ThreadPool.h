@@ -0,0 +1,37 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+// Fixed set of worker threads running posted jobs in order of posting.
+// Shared by all stages of a TaskGraph: coroutines are resumed on it, so a stage waiting
+// for input or for room in a channel occupies no thread
+class ThreadPool
+{
+public:
+    // threads == 0 - one thread per hardware thread
+    ThreadPool(unsigned int threads = 0);
+    // Runs the jobs already posted, then joins the threads
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned int countThreads() const { return (unsigned int)threads.size(); }
+
+    void post(std::function<void()> job);
+
+private:
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::function<void()>> jobs;
+    bool stopping = false;
+
+    void work();
+};
@@ -0,0 +1,24 @@
+# Writes a shader as a C++ header with its source in a raw string literal.
+# Run by the build for every shader of Resources, see the CustomBuild items of PhysicalPendulum.vcxproj
+param(
+    [Parameter(Mandatory = $true)][string]$Source,
+    [Parameter(Mandatory = $true)][string]$Output
+)
+
+$file_name = [IO.Path]::GetFileName($Source)
+# default.vert -> default_vert
+$name = $file_name -replace '[^A-Za-z0-9_]', '_'
+$text = [IO.File]::ReadAllText($Source)
+
+if ($text.Contains(')glsl"'))
+{
+    throw "$Source contains the raw string delimiter )glsl`""
+}
+
+New-Item -ItemType Directory -Force -Path ([IO.Path]::GetDirectoryName($Output)) | Out-Null
+
+$header = "// Generated from $file_name by EmbedShader.ps1, do not edit`r`n" +
+          "#pragma once`r`n`r`n" +
+          "static const char ${name}[] = R`"glsl($text)glsl`";`r`n"
+
+[IO.File]::WriteAllText($Output, $header)
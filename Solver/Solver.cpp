@@ -1,26 +1,47 @@
 #include "Solver.h"
 
-SolverODEs::SolverODEs() : method_id(Undefined), step(0.005f)
+#include <cmath>
+#include <limits>
+
+template<typename T, typename E>
+BasicSolverODEs<T, E>::BasicSolverODEs() : method_id(Undefined), step(T(0.005)), tolerance(T(1e-6)), adaptive_step(0), evaluations(0), rejected_steps(0)
 {
 }
 
-SolverODEs::~SolverODEs()
+template<typename T, typename E>
+BasicSolverODEs<T, E>::~BasicSolverODEs()
 {
 }
 
-void SolverODEs::SolveRK4(const float* y_in, std::function<void(const float*, float*)>& func, float* y_out, const unsigned int size)
+template<typename T, typename E>
+void BasicSolverODEs<T, E>::evaluate(Derivates& func, const T* y, T* derivates, E* y_eval, E* derivates_eval, const unsigned int size)
+{
+    for (unsigned int i = 0; i < size; ++i)
+        y_eval[i] = (E)y[i];
+
+    func(y_eval, derivates_eval);
+
+    for (unsigned int i = 0; i < size; ++i)
+        derivates[i] = derivates_eval[i];
+}
+
+template<typename T, typename E>
+void BasicSolverODEs<T, E>::SolveRK4(const T* y_in, Derivates& func, T* y_out, const unsigned int size)
 {
-    float* derivates = new float[size] {};
-    float* y_temp = new float[size] {};
-    float** k = new float*[4] {};
+    T* derivates = new T[size] {};
+    T* y_temp = new T[size] {};
+    T** k = new T*[4] {};
+
+    E* y_eval = new E[size] {};
+    E* derivates_eval = new E[size] {};
 
     for (int i = 0; i < 4; ++i)
     {
-        k[i] = new float[size] {};
+        k[i] = new T[size] {};
     }
 
     // 1
-    func(y_in, derivates);
+    evaluate(func, y_in, derivates, y_eval, derivates_eval, size);
     for (int i = 0; i < size; ++i)
     {
         k[0][i] = step * derivates[i];
@@ -28,7 +49,7 @@ void SolverODEs::SolveRK4(const float* y_in, std::function<void(const float*, fl
     }
 
     // 2
-    func(y_temp, derivates);
+    evaluate(func, y_temp, derivates, y_eval, derivates_eval, size);
     for (int i = 0; i < size; ++i)
     {
         k[1][i] = step * derivates[i];
@@ -36,7 +57,7 @@ void SolverODEs::SolveRK4(const float* y_in, std::function<void(const float*, fl
     }
 
     // 3
-    func(y_temp, derivates);
+    evaluate(func, y_temp, derivates, y_eval, derivates_eval, size);
     for (int i = 0; i < size; ++i)
     {
         k[2][i] = step * derivates[i];
@@ -44,19 +65,27 @@ void SolverODEs::SolveRK4(const float* y_in, std::function<void(const float*, fl
     }
 
     // 4
-    func(y_temp, derivates);
+    evaluate(func, y_temp, derivates, y_eval, derivates_eval, size);
     for (int i = 0; i < size; ++i)
     {
         k[3][i] = step * derivates[i];
         y_out[i] = y_in[i] + k[0][i] / 6 + k[1][i] / 3 + k[2][i] / 3 + k[3][i] / 6;
     }
 
+    evaluations += 4;
+
     delete[] derivates;
     derivates = nullptr;
 
     delete[] y_temp;
     y_temp = nullptr;
 
+    delete[] y_eval;
+    y_eval = nullptr;
+
+    delete[] derivates_eval;
+    derivates_eval = nullptr;
+
     for (int i = 0; i < 4; ++i)
     {
         delete[] k[i];
@@ -66,9 +95,182 @@ void SolverODEs::SolveRK4(const float* y_in, std::function<void(const float*, fl
     k = nullptr;
 }
 
-std::string SolverODEs::getStringMethod()
+template<typename T, typename E>
+void BasicSolverODEs<T, E>::SolveRK45(const T* y_in, Derivates& func, T* y_out, const unsigned int size)
 {
-    switch (method_id)
+    using std::fabs;
+    using std::fmax;
+    using std::fmin;
+    using std::pow;
+
+    // Dormand-Prince tableau
+    static const T a[7][6] = {
+        {},
+        { T(1) / 5 },
+        { T(3) / 40, T(9) / 40 },
+        { T(44) / 45, T(-56) / 15, T(32) / 9 },
+        { T(19372) / 6561, T(-25360) / 2187, T(64448) / 6561, T(-212) / 729 },
+        { T(9017) / 3168, T(-355) / 33, T(46732) / 5247, T(49) / 176, T(-5103) / 18656 },
+        { T(35) / 384, T(0), T(500) / 1113, T(125) / 192, T(-2187) / 6784, T(11) / 84 }
+    };
+    // Difference between the 5th and 4th order weights
+    static const T e[7] = { T(71) / 57600, T(0), T(-71) / 16695, T(71) / 1920, T(-17253) / 339200, T(22) / 525, T(-1) / 40 };
+
+    T* y = new T[size] {};
+    T* y_temp = new T[size] {};
+    T** k = new T*[7] {};
+
+    E* y_eval = new E[size] {};
+    E* derivates_eval = new E[size] {};
+
+    for (int i = 0; i < 7; ++i)
+    {
+        k[i] = new T[size] {};
+    }
+
+    for (int i = 0; i < size; ++i)
+    {
+        y[i] = y_in[i];
+    }
+
+    T time = 0;
+    const T min_step = step * T(1e-6);
+
+    // k[0] is valid at the start of every substep (first same as last)
+    evaluate(func, y, k[0], y_eval, derivates_eval, size);
+    ++evaluations;
+
+    T h = adaptive_step;
+    if (!(h > 0))
+    {
+        // Starting step estimate of Hairer, Norsett & Wanner (II.4), with the error scale used below:
+        // an explicit Euler step of size h0 probes the second derivative
+        T d0 = 0, d1 = 0;
+        for (int i = 0; i < size; ++i)
+        {
+            const T scale = tolerance * (1 + fabs(y[i]));
+            d0 = fmax(d0, fabs(y[i]) / scale);
+            d1 = fmax(d1, fabs(k[0][i]) / scale);
+        }
+
+        const T h0 = d0 < T(1e-5) || d1 < T(1e-5) ? T(1e-6) : T(0.01) * d0 / d1;
+
+        for (int i = 0; i < size; ++i)
+            y_temp[i] = y[i] + h0 * k[0][i];
+        evaluate(func, y_temp, k[1], y_eval, derivates_eval, size);
+        ++evaluations;
+
+        T d2 = 0;
+        for (int i = 0; i < size; ++i)
+            d2 = fmax(d2, fabs(k[1][i] - k[0][i]) / (tolerance * (1 + fabs(y[i]))));
+        d2 /= h0;
+
+        const T d = fmax(d1, d2);
+        const T h1 = d <= T(1e-15) ? fmax(T(1e-6), h0 * T(1e-3)) : pow(T(0.01) / d, T(0.2));
+
+        h = fmin(T(100) * h0, h1);
+        // Not finite only with a non-finite state, which no step size can fix
+        if (!std::isfinite(h))
+            h = step;
+    }
+    h = fmax(fmin(h, step), min_step);
+
+    while (time < step)
+    {
+        bool last = false;
+        if (time + h >= step)
+        {
+            h = step - time;
+            last = true;
+        }
+
+        for (int s = 1; s < 7; ++s)
+        {
+            for (int i = 0; i < size; ++i)
+            {
+                T sum = 0;
+                for (int j = 0; j < s; ++j)
+                    sum += a[s][j] * k[j][i];
+
+                y_temp[i] = y[i] + h * sum;
+            }
+
+            evaluate(func, y_temp, k[s], y_eval, derivates_eval, size);
+        }
+        evaluations += 6;
+
+        // y_temp holds the 5th order solution after the last stage
+        T error = 0;
+        for (int i = 0; i < size; ++i)
+        {
+            T err_i = 0;
+            for (int j = 0; j < 7; ++j)
+                err_i += e[j] * k[j][i];
+
+            T scale = tolerance * (1 + fmax(fabs(y[i]), fabs(y_temp[i])));
+            T err_scaled = fabs(h * err_i) / scale;
+
+            // fmax ignores NaN, an overflowing stage must reject the step instead
+            if (!std::isfinite(err_scaled) || !std::isfinite(y_temp[i]))
+                err_scaled = std::numeric_limits<T>::infinity();
+
+            error = fmax(error, err_scaled);
+        }
+
+        T factor = error > 0 ? T(0.9) * pow(error, T(-0.2)) : T(5);
+        factor = fmin(T(5), fmax(T(0.2), factor));
+
+        // At the minimal step even a non-finite step is accepted, so that a diverged state ends the call
+        if (error <= 1 || h <= min_step)
+        {
+            time = last ? step : time + h;
+
+            for (int i = 0; i < size; ++i)
+            {
+                y[i] = y_temp[i];
+                k[0][i] = k[6][i];
+            }
+
+            if (!last)
+                adaptive_step = h * factor;
+            h *= factor;
+        }
+        else
+        {
+            ++rejected_steps;
+            h = fmax(h * factor, min_step);
+        }
+    }
+
+    for (int i = 0; i < size; ++i)
+    {
+        y_out[i] = y[i];
+    }
+
+    delete[] y;
+    y = nullptr;
+
+    delete[] y_temp;
+    y_temp = nullptr;
+
+    delete[] y_eval;
+    y_eval = nullptr;
+
+    delete[] derivates_eval;
+    derivates_eval = nullptr;
+
+    for (int i = 0; i < 7; ++i)
+    {
+        delete[] k[i];
+        k[i] = nullptr;
+    }
+    delete[] k;
+    k = nullptr;
+}
+
+std::string SolverMethods::getStringMethod(Method method)
+{
+    switch (method)
     {
     case Undefined:
         return "Undefined";
@@ -76,8 +278,27 @@ std::string SolverODEs::getStringMethod()
     case RungeKutta4:
         return "RungeKutta4";
 
+    case RungeKutta45:
+        return "RungeKutta45";
+
+    case Taylor:
+        return "Taylor";
+
     default:
-        method_id = Undefined;
         return "Undefined";
     }
 }
+
+template<typename T, typename E>
+std::string BasicSolverODEs<T, E>::getStringMethod()
+{
+    if (method_id != Undefined && method_id != RungeKutta4 && method_id != RungeKutta45 && method_id != Taylor)
+        method_id = Undefined;
+
+    return SolverMethods::getStringMethod(method_id);
+}
+
+template class BasicSolverODEs<float>;
+template class BasicSolverODEs<double>;
+template class BasicSolverODEs<double, float>;
+template class BasicSolverODEs<long double>;
@@ -5,22 +5,44 @@
 
 #include <functional>
 
-class SolverODEs
+class SolverMethods
 {
 public:
     enum Method
     {
         Undefined,
-        RungeKutta4
+        RungeKutta4,
+        RungeKutta45,
+        Taylor
     };
 
+    static std::string getStringMethod(Method method);
+};
+
+// T - scalar type of the accumulated state
+// E - scalar type in which the derivates are evaluated (float derivates with double state for mixed precision)
+template<typename T, typename E = T>
+class BasicSolverODEs : public SolverMethods
+{
 public:
-    SolverODEs();
-    virtual ~SolverODEs();
+    using Derivates = std::function<void(const E*, E*)>;
+
+public:
+    BasicSolverODEs();
+    virtual ~BasicSolverODEs();
+
+    void SolveRK4(const T* y_in, Derivates& func, T* y_out, const unsigned int size);
+    // Dormand-Prince 5(4) with adaptive substeps over the whole step
+    void SolveRK45(const T* y_in, Derivates& func, T* y_out, const unsigned int size);
 
-    void SolveRK4(const float* y_in, std::function<void(const float*, float*)>& func, float* y_out, const unsigned int size);
+    void setStep(T p_step) { step = p_step; }
 
-    void setStep(float p_step) { step = p_step; }
+    T getTolerance() const { return tolerance; }
+    void setTolerance(T p_tolerance) { tolerance = p_tolerance; }
+
+    unsigned long long countEvaluations() const { return evaluations; }
+    unsigned long long countRejectedSteps() const { return rejected_steps; }
+    void resetCounters() { evaluations = 0; rejected_steps = 0; }
 
     Method getMethod() const { return method_id; }
     std::string getStringMethod();
@@ -28,6 +50,19 @@ public:
 
 protected:
     
-    float step;
     Method method_id;
+    T step;
+
+    T tolerance;
+    // Last accepted substep of SolveRK45, reused as the initial guess of the next call
+    T adaptive_step;
+
+    unsigned long long evaluations;
+    unsigned long long rejected_steps;
+
+private:
+    // Converts the state to E, evaluates and converts the derivates back
+    void evaluate(Derivates& func, const T* y, T* derivates, E* y_eval, E* derivates_eval, const unsigned int size);
 };
+
+using SolverODEs = BasicSolverODEs<float>;
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+
+#include "TaylorSeries.h"
+
+// Taylor series integrator with order selected from the tolerance and step selected
+// from the decay of the last coefficients (Jorba & Zou).
+template<typename T>
+class SolverTaylor
+{
+public:
+    // Writes normalized Taylor coefficients of the solution through y up to the given order.
+    // coeffs[i * (order + 1) + k] - k-th coefficient of y[i]
+    using Coefficients = std::function<void(const T* y, unsigned int order, T* coeffs)>;
+
+public:
+    SolverTaylor() : tolerance(1e-12), min_order(10), max_order(30), steps(0), evaluations(0)
+    {
+    }
+
+    // Advances y_in by the interval, taking as many adaptive steps as needed
+    void SolveTaylor(const T* y_in, Coefficients& func, T* y_out, const unsigned int size, T interval)
+    {
+        const unsigned int order = selectOrder();
+
+        T* y = new T[size] {};
+        T* coeffs = new T[size * (order + 1)] {};
+
+        for (unsigned int i = 0; i < size; ++i)
+            y[i] = y_in[i];
+
+        T time = 0;
+        while (time < interval)
+        {
+            func(y, order, coeffs);
+            ++evaluations;
+
+            T h = selectStep(y, coeffs, size, order);
+            bool last = false;
+            if (time + h >= interval)
+            {
+                h = interval - time;
+                last = true;
+            }
+
+            // Horner evaluation of every component at h
+            for (unsigned int i = 0; i < size; ++i)
+            {
+                const T* c = coeffs + i * (order + 1);
+
+                T value = c[order];
+                for (unsigned int k = order; k-- > 0;)
+                    value = value * h + c[k];
+
+                y[i] = value;
+            }
+
+            time = last ? interval : time + h;
+            ++steps;
+        }
+
+        for (unsigned int i = 0; i < size; ++i)
+            y_out[i] = y[i];
+
+        delete[] y;
+        y = nullptr;
+
+        delete[] coeffs;
+        coeffs = nullptr;
+    }
+
+    unsigned int selectOrder() const
+    {
+        unsigned int order = (unsigned int)std::ceil(-std::log(tolerance) / 2) + 1;
+
+        if (order < min_order)
+            order = min_order;
+        if (order > max_order)
+            order = max_order;
+
+        return order;
+    }
+
+    T getTolerance() const { return tolerance; }
+    void setTolerance(T p_tolerance) { tolerance = p_tolerance; }
+
+    // Orders below step_tail + 1 are raised to it: selectStep divides by order - j for the last step_tail coefficients,
+    // which then never include the first derivative
+    void setOrderLimits(unsigned int p_min_order, unsigned int p_max_order)
+    {
+        const unsigned int lowest_order = step_tail + 1;
+
+        max_order = p_max_order < max_taylor_order ? p_max_order : max_taylor_order;
+        max_order = max_order > lowest_order ? max_order : lowest_order;
+        min_order = p_min_order < max_order ? p_min_order : max_order;
+        min_order = min_order > lowest_order ? min_order : lowest_order;
+    }
+
+    unsigned long long countSteps() const { return steps; }
+    unsigned long long countEvaluations() const { return evaluations; }
+    void resetCounters() { steps = 0; evaluations = 0; }
+
+protected:
+    // The last two coefficients alone may both vanish by symmetry (e.g. every other pair for
+    // a pendulum released from rest), so the radius is estimated from the last four.
+    static const unsigned int step_tail = 4;
+
+    T selectStep(const T* y, const T* coeffs, const unsigned int size, unsigned int order) const
+    {
+        T norm_y = 0;
+        T norm[step_tail] = {};
+        for (unsigned int i = 0; i < size; ++i)
+        {
+            const T* c = coeffs + i * (order + 1);
+
+            norm_y = std::fmax(norm_y, std::fabs(y[i]));
+            for (unsigned int j = 0; j < step_tail; ++j)
+                norm[j] = std::fmax(norm[j], std::fabs(c[order - j]));
+        }
+
+        // Mixed absolute/relative error per step
+        const T eps = tolerance * (norm_y > 1 ? norm_y : T(1));
+
+        T h = (T)HUGE_VAL;
+        for (unsigned int j = 0; j < step_tail; ++j)
+        {
+            if (norm[j] > 0)
+                h = std::fmin(h, std::pow(eps / norm[j], T(1) / (order - j)));
+        }
+
+        // Safety factor from Jorba & Zou
+        return h * std::exp(T(-0.7) / (order - 1));
+    }
+
+    T tolerance;
+    unsigned int min_order;
+    unsigned int max_order;
+
+    unsigned long long steps;
+    unsigned long long evaluations;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cmath>
+
+// Recursive Taylor arithmetic (automatic differentiation).
+// A series is an array of normalized coefficients: u[k] = u^(k)(t) / k!
+// Every function computes the k-th coefficient of the result assuming
+// coefficients 0..k of the arguments and 0..k-1 of the result are already known.
+
+const unsigned int max_taylor_order = 32;
+
+template<typename T>
+T taylor_mul(const T* u, const T* v, unsigned int k)
+{
+    T sum = 0;
+    for (unsigned int j = 0; j <= k; ++j)
+        sum += u[j] * v[k - j];
+
+    return sum;
+}
+
+// q = u / v
+template<typename T>
+T taylor_div(const T* u, const T* v, const T* q, unsigned int k)
+{
+    T sum = u[k];
+    for (unsigned int j = 1; j <= k; ++j)
+        sum -= v[j] * q[k - j];
+
+    return sum / v[0];
+}
+
+// s = sin(u), c = cos(u), both written at index k
+template<typename T>
+void taylor_sincos(const T* u, T* s, T* c, unsigned int k)
+{
+    if (k == 0)
+    {
+        // Unqualified, so that scalar types with their own sin and cos are found by argument lookup
+        using std::sin;
+        using std::cos;
+        s[0] = sin(u[0]);
+        c[0] = cos(u[0]);
+        return;
+    }
+
+    T sum_s = 0, sum_c = 0;
+    for (unsigned int j = 1; j <= k; ++j)
+    {
+        sum_s += j * u[j] * c[k - j];
+        sum_c += j * u[j] * s[k - j];
+    }
+
+    s[k] = sum_s / k;
+    c[k] = -sum_c / k;
+}
@@ -0,0 +1,239 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include "SweepSpec.h"
+#include "SweepShard.h"
+
+// Usage:
+//   Sweep run    spec [--out prefix] [--shards K] [--jobs J] [--range first last --shards K] [--force] [--csv file]
+//   Sweep worker spec --shard i --shards K [--out prefix]
+//   Sweep merge  spec [--out prefix] [--shards K] [--csv file]
+//
+// run starts a worker process for every shard of [first, last) that is not complete yet, at most J at once,
+// and merges the shards when all K are complete. K defaults to the number of cores of this host, so --range
+// and worker, which take part in a sharding decided elsewhere, require --shards. Several hosts share a sweep
+// by running disjoint ranges of the same K with one spec, after which the shard files are collected and merged.
+// A crashed shard is re-run alone with worker or run.
+
+struct Options
+{
+    std::string prefix = "sweep";
+    unsigned int shards = 0;
+    unsigned int jobs = 0;
+    unsigned int shard = 0;
+    bool has_shard = false;
+    unsigned int first = 0;
+    unsigned int last = 0;
+    bool has_range = false;
+    bool force = false;
+    std::string csv;
+};
+
+static void print_usage()
+{
+    std::cout << "Usage:" << std::endl
+              << "  Sweep run    spec [--out prefix] [--shards K] [--jobs J] [--range first last --shards K] [--force] [--csv file]" << std::endl
+              << "  Sweep worker spec --shard i --shards K [--out prefix]" << std::endl
+              << "  Sweep merge  spec [--out prefix] [--shards K] [--csv file]" << std::endl;
+}
+
+// Whole decimal number that fits unsigned int, no sign and nothing after it
+static bool parse_unsigned(const char* text, unsigned int& value)
+{
+    if (*text < '0' || *text > '9')
+        return false;
+
+    errno = 0;
+    char* end = nullptr;
+    const unsigned long result = std::strtoul(text, &end, 10);
+    if (*end != '\0' || errno == ERANGE || result > UINT_MAX)
+        return false;
+
+    value = (unsigned int)result;
+    return true;
+}
+
+static std::string quote(const std::string& argument)
+{
+    return "\"" + argument + "\"";
+}
+
+static bool run_workers(const char* program, const char* spec_filename, const SweepSpec& spec, const Options& options)
+{
+    std::vector<unsigned int> pending;
+    for (unsigned int shard = options.first; shard < options.last; ++shard)
+    {
+        if (options.force || !is_shard_complete(spec, shard, options.shards, options.prefix))
+            pending.push_back(shard);
+    }
+
+    std::cout << pending.size() << " of " << options.last - options.first << " shards to run, "
+              << options.jobs << " at once" << std::endl;
+
+    std::atomic<size_t> next(0);
+    std::vector<unsigned int> failed;
+    std::mutex failed_mutex;
+
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < pending.size(); i = next++)
+        {
+            const unsigned int shard = pending[i];
+
+            std::string command = quote(program) + " worker " + quote(spec_filename) + " --shard " + std::to_string(shard)
+                                + " --shards " + std::to_string(options.shards) + " --out " + quote(options.prefix);
+#ifdef _WIN32
+            // cmd.exe strips the outer pair of quotes
+            command = "\"" + command + "\"";
+#endif
+
+            if (std::system(command.c_str()) != 0 || !is_shard_complete(spec, shard, options.shards, options.prefix))
+            {
+                std::lock_guard<std::mutex> lock(failed_mutex);
+                failed.push_back(shard);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < options.jobs; ++i)
+        threads.emplace_back(worker);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (unsigned int shard : failed)
+    {
+        std::cout << "Shard " << shard << " failed, re-run it with: " << program << " worker " << spec_filename
+                  << " --shard " << shard << " --shards " << options.shards << " --out " << options.prefix << std::endl;
+    }
+
+    return failed.empty();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        print_usage();
+        return 1;
+    }
+
+    const char* command = argv[1];
+    const char* spec_filename = argv[2];
+
+    Options options;
+    for (int i = 3; i < argc; ++i)
+    {
+        const char* option = argv[i];
+        const bool has_value = i + 1 < argc;
+        bool valid = true;
+
+        if (strcmp(option, "--force") == 0)
+            options.force = true;
+        else if (strcmp(option, "--out") == 0 && has_value)
+            options.prefix = argv[++i];
+        else if (strcmp(option, "--shards") == 0 && has_value)
+            valid = parse_unsigned(argv[++i], options.shards) && options.shards > 0;
+        else if (strcmp(option, "--jobs") == 0 && has_value)
+            valid = parse_unsigned(argv[++i], options.jobs) && options.jobs > 0;
+        else if (strcmp(option, "--shard") == 0 && has_value)
+            valid = options.has_shard = parse_unsigned(argv[++i], options.shard);
+        else if (strcmp(option, "--range") == 0 && i + 2 < argc)
+        {
+            valid = parse_unsigned(argv[i + 1], options.first) && parse_unsigned(argv[i + 2], options.last) && options.first < options.last;
+            options.has_range = valid;
+            i += 2;
+        }
+        else if (strcmp(option, "--csv") == 0 && has_value)
+            options.csv = argv[++i];
+        else
+        {
+            std::cout << "Unknown or incomplete option " << option << std::endl;
+            print_usage();
+            return 1;
+        }
+
+        if (!valid)
+        {
+            std::cout << "Invalid value of " << option << std::endl;
+            print_usage();
+            return 1;
+        }
+    }
+
+    // The default depends on the host, shards of hosts with other core counts would not fit together
+    if (options.shards == 0 && (options.has_range || strcmp(command, "worker") == 0))
+    {
+        std::cout << "--range and worker need --shards" << std::endl;
+        print_usage();
+        return 1;
+    }
+
+    const unsigned int cores = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+    if (options.shards == 0)
+        options.shards = cores;
+    if (options.jobs == 0)
+        options.jobs = cores;
+    if (!options.has_range)
+    {
+        options.first = 0;
+        options.last = options.shards;
+    }
+
+    if ((options.has_shard && options.shard >= options.shards) || (options.has_range && options.last > options.shards))
+    {
+        std::cout << "--shard and --range must lie within the " << options.shards << " shards" << std::endl;
+        print_usage();
+        return 1;
+    }
+
+    if (options.csv.empty())
+        options.csv = options.prefix + ".csv";
+
+    SweepSpec spec;
+    if (!read_sweep_spec(spec_filename, spec))
+        return 1;
+
+    std::cout << count_scenarios(spec) << " scenarios in " << options.shards << " shards" << std::endl;
+
+    if (strcmp(command, "worker") == 0)
+    {
+        if (!options.has_shard)
+        {
+            std::cout << "worker needs --shard" << std::endl;
+            return 1;
+        }
+
+        return run_shard(spec, options.shard, options.shards, options.prefix) ? 0 : 1;
+    }
+
+    if (strcmp(command, "run") == 0)
+    {
+        if (!run_workers(argv[0], spec_filename, spec, options))
+            return 1;
+
+        // Other hosts may still be running the rest of the shards
+        for (unsigned int shard = 0; shard < options.shards; ++shard)
+        {
+            if (!is_shard_complete(spec, shard, options.shards, options.prefix))
+                return 0;
+        }
+
+        return merge_shards(spec, options.shards, options.prefix, options.csv.c_str()) ? 0 : 1;
+    }
+
+    if (strcmp(command, "merge") == 0)
+        return merge_shards(spec, options.shards, options.prefix, options.csv.c_str()) ? 0 : 1;
+
+    std::cout << "Unknown command " << command << std::endl;
+    return 1;
+}
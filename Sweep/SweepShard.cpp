@@ -0,0 +1,227 @@
+#include "SweepShard.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+#include "PendulumEnsemble.h"
+
+namespace
+{
+    const char shard_magic[4] = { 'P', 'S', 'W', 'P' };
+    const uint32_t shard_version = 1;
+
+    // Fixed-width fields without padding, followed by the records
+    struct ShardHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t spec_hash;
+        uint64_t scenarios;
+        uint32_t shard;
+        uint32_t shards;
+        uint64_t records;
+    };
+
+    ShardHeader make_header(const SweepSpec& spec, unsigned int shard, unsigned int shards)
+    {
+        ShardHeader header;
+        std::memcpy(header.magic, shard_magic, sizeof(shard_magic));
+        header.version = shard_version;
+        header.spec_hash = hash_sweep_spec(spec);
+        header.scenarios = count_scenarios(spec);
+        header.shard = shard;
+        header.shards = shards;
+        header.records = count_shard_scenarios(spec, shard, shards);
+
+        return header;
+    }
+
+    bool read_header(std::istream& in, const SweepSpec& spec, unsigned int shard, unsigned int shards)
+    {
+        const ShardHeader expected = make_header(spec, shard, shards);
+        ShardHeader header;
+
+        return in.read(reinterpret_cast<char*>(&header), sizeof(header)) && std::memcmp(&header, &expected, sizeof(header)) == 0;
+    }
+
+    template<typename T>
+    bool integrate_shard(const SweepSpec& spec, unsigned int shard, unsigned int shards, std::ostream& out)
+    {
+        const unsigned long long scenarios = count_scenarios(spec);
+        const unsigned long long stride = shards;
+
+        std::vector<T> arrays[NumAxes];
+        for (auto& array : arrays)
+            array.resize(spec.batch);
+
+        std::vector<ScenarioResult> results(spec.batch);
+        double values[NumAxes] = {};
+
+        unsigned long long index = shard;
+        while (index < scenarios)
+        {
+            unsigned int n = 0;
+            for (; index < scenarios && n < spec.batch; index += stride, ++n)
+            {
+                get_scenario(spec, index, values);
+                for (int axis = 0; axis < NumAxes; ++axis)
+                    arrays[axis][n] = (T)values[axis];
+            }
+
+            // The ensemble steps the batch arrays in place
+            BasicPendulumEnsemble<T> ensemble(n, arrays[Theta1].data(), arrays[Omega1].data(), arrays[Theta2].data(), arrays[Omega2].data(),
+                                              arrays[Mass1].data(), arrays[Length1].data(), arrays[Mass2].data(), arrays[Length2].data());
+            ensemble.setDriftThreshold((T)spec.drift_threshold);
+            ensemble.calculatePhysicalModel((T)spec.step, spec.steps);
+
+            for (unsigned int i = 0; i < n; ++i)
+            {
+                results[i].theta1 = arrays[Theta1][i];
+                results[i].omega1 = arrays[Omega1][i];
+                results[i].theta2 = arrays[Theta2][i];
+                results[i].omega2 = arrays[Omega2][i];
+                results[i].energy_drift = ensemble.getEnergyDrift(i);
+            }
+
+            if (!out.write(reinterpret_cast<const char*>(results.data()), sizeof(ScenarioResult) * n))
+                return false;
+        }
+
+        return true;
+    }
+}
+
+std::string get_shard_filename(const std::string& prefix, unsigned int shard, unsigned int shards)
+{
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), ".shard-%04u-of-%04u", shard, shards);
+
+    return prefix + buffer;
+}
+
+unsigned long long count_shard_scenarios(const SweepSpec& spec, unsigned int shard, unsigned int shards)
+{
+    const unsigned long long scenarios = count_scenarios(spec);
+
+    return shard < scenarios ? (scenarios - shard + shards - 1) / shards : 0;
+}
+
+bool is_shard_complete(const SweepSpec& spec, unsigned int shard, unsigned int shards, const std::string& prefix)
+{
+    std::ifstream file(get_shard_filename(prefix, shard, shards), std::ios::binary);
+
+    return file && read_header(file, spec, shard, shards);
+}
+
+bool run_shard(const SweepSpec& spec, unsigned int shard, unsigned int shards, const std::string& prefix)
+{
+    if (shards == 0 || shard >= shards)
+    {
+        std::cout << "Uncorrect shard " << shard << " of " << shards << std::endl;
+        return false;
+    }
+
+    const std::string filename = get_shard_filename(prefix, shard, shards);
+    const std::string temp_filename = filename + ".tmp";
+
+    std::ofstream out(temp_filename, std::ios::binary);
+    if (!out)
+    {
+        std::cout << "Failed to open " << temp_filename << std::endl;
+        return false;
+    }
+
+    const ShardHeader header = make_header(spec, shard, shards);
+    bool written = !!out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (written)
+        written = spec.use_double ? integrate_shard<double>(spec, shard, shards, out) : integrate_shard<float>(spec, shard, shards, out);
+
+    out.close();
+    written = !out.fail() && written;
+
+    // The shard appears under its final name only when whole
+    std::remove(filename.c_str());
+    if (!written || std::rename(temp_filename.c_str(), filename.c_str()) != 0)
+    {
+        std::cout << "Failed to write " << filename << std::endl;
+        std::remove(temp_filename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool merge_shards(const SweepSpec& spec, unsigned int shards, const std::string& prefix, const char* csv_filename)
+{
+    std::vector<std::ifstream> files(shards);
+    bool complete = true;
+
+    for (unsigned int shard = 0; shard < shards; ++shard)
+    {
+        files[shard].open(get_shard_filename(prefix, shard, shards), std::ios::binary);
+        if (!files[shard] || !read_header(files[shard], spec, shard, shards))
+        {
+            std::cout << "Shard " << shard << " of " << shards << " is missing or belongs to another sweep" << std::endl;
+            complete = false;
+        }
+    }
+
+    std::ofstream out;
+    if (complete)
+    {
+        out.open(csv_filename);
+        if (!out)
+            std::cout << "Failed to open " << csv_filename << std::endl;
+    }
+
+    if (complete && out)
+    {
+        out << "index";
+        for (int axis = 0; axis < NumAxes; ++axis)
+            out << ',' << get_axis_name(axis);
+        out << ",theta1_end,omega1_end,theta2_end,omega2_end,energy_drift\n";
+        out << std::setprecision(9);
+
+        // Scenario i is the next record of shard i % shards
+        const unsigned long long scenarios = count_scenarios(spec);
+        double values[NumAxes] = {};
+        ScenarioResult result;
+        unsigned long long drifting = 0;
+
+        for (unsigned long long index = 0; index < scenarios && complete; ++index)
+        {
+            if (!files[index % shards].read(reinterpret_cast<char*>(&result), sizeof(result)))
+            {
+                std::cout << "Shard " << index % shards << " of " << shards << " is truncated" << std::endl;
+                complete = false;
+                break;
+            }
+
+            get_scenario(spec, index, values);
+
+            out << index;
+            for (int axis = 0; axis < NumAxes; ++axis)
+                out << ',' << values[axis];
+            out << ',' << result.theta1 << ',' << result.omega1 << ',' << result.theta2 << ',' << result.omega2
+                << ',' << result.energy_drift << '\n';
+
+            if (result.energy_drift != 0.0)
+                ++drifting;
+        }
+
+        // Any integration in finite precision drifts, a column of zeros means the drift was not computed
+        if (complete && spec.steps > 0 && scenarios > 0 && drifting == 0)
+            std::cout << "Warning: energy drift is zero for every scenario of " << csv_filename << std::endl;
+    }
+
+    if (complete && out)
+        std::cout << "Merged " << count_scenarios(spec) << " scenarios into " << csv_filename << std::endl;
+
+    return complete && out;
+}
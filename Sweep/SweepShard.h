@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+#include "SweepSpec.h"
+
+// Scenarios are dealt to shards round-robin (scenario i goes to shard i % shards), so that every shard
+// gets the same mix of cheap and expensive scenarios. A shard is one file of fixed-size records in the
+// order of its scenarios, written under a temporary name and renamed when complete: an existing shard
+// file is always whole and is not recomputed.
+
+// Final state of one scenario after spec.steps steps
+struct ScenarioResult
+{
+    double theta1 = 0.0;
+    double omega1 = 0.0;
+    double theta2 = 0.0;
+    double omega2 = 0.0;
+    double energy_drift = 0.0;
+};
+
+std::string get_shard_filename(const std::string& prefix, unsigned int shard, unsigned int shards);
+unsigned long long count_shard_scenarios(const SweepSpec& spec, unsigned int shard, unsigned int shards);
+
+// Whether the shard file exists and was written for this spec and sharding
+bool is_shard_complete(const SweepSpec& spec, unsigned int shard, unsigned int shards, const std::string& prefix);
+bool run_shard(const SweepSpec& spec, unsigned int shard, unsigned int shards, const std::string& prefix);
+
+// Combines all shards into one CSV indexed by scenario, fails listing the missing shards
+bool merge_shards(const SweepSpec& spec, unsigned int shards, const std::string& prefix, const char* csv_filename);
@@ -0,0 +1,176 @@
+#include "SweepSpec.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+#include "PendulumEquations.h"
+
+static const char* axis_names[NumAxes] = { "mass1", "l1", "mass2", "l2", "theta1", "omega1", "theta2", "omega2" };
+
+const char* get_axis_name(int axis)
+{
+    return axis >= 0 && axis < NumAxes ? axis_names[axis] : "";
+}
+
+static bool parse_values(std::istringstream& in, std::vector<double>& values)
+{
+    std::string word;
+    values.clear();
+
+    while (in >> word)
+    {
+        if (word == "linspace")
+        {
+            double first = 0, last = 0;
+            unsigned int count = 0;
+            if (!(in >> first >> last >> count) || count == 0)
+                return false;
+
+            for (unsigned int i = 0; i < count; ++i)
+                values.push_back(count > 1 ? first + (last - first) * i / (count - 1) : first);
+            continue;
+        }
+
+        std::istringstream number(word);
+        double value = 0;
+        if (!(number >> value))
+            return false;
+
+        values.push_back(value);
+    }
+
+    return !values.empty();
+}
+
+bool read_sweep_spec(const char* filename, SweepSpec& spec)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        std::cout << "Failed to open " << filename << std::endl;
+        return false;
+    }
+
+    const double defaults[NumAxes] = { 1, 1, 1, 1, PendulumConstants<double>::pi / 2, 0, PendulumConstants<double>::pi / 2, 0 };
+    for (int i = 0; i < NumAxes; ++i)
+        spec.axes[i].assign(1, defaults[i]);
+
+    std::string line;
+    unsigned int line_number = 0;
+
+    while (std::getline(file, line))
+    {
+        ++line_number;
+
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        const size_t equal = line.find('=');
+        std::istringstream key_stream(line.substr(0, equal));
+        std::string key;
+        if (!(key_stream >> key))
+            continue;
+
+        std::istringstream in(equal != std::string::npos ? line.substr(equal + 1) : std::string());
+
+        int axis = 0;
+        while (axis < NumAxes && key != axis_names[axis])
+            ++axis;
+
+        bool correct = true;
+        if (equal == std::string::npos)
+        {
+            correct = false;
+        }
+        else if (axis < NumAxes)
+        {
+            correct = parse_values(in, spec.axes[axis]);
+        }
+        else if (key == "step")
+        {
+            correct = (in >> spec.step) && spec.step > 0;
+        }
+        else if (key == "steps")
+        {
+            correct = !!(in >> spec.steps);
+        }
+        else if (key == "precision")
+        {
+            std::string precision;
+            correct = (in >> precision) && (precision == "float" || precision == "double");
+            spec.use_double = precision == "double";
+        }
+        else if (key == "drift_threshold")
+        {
+            correct = !!(in >> spec.drift_threshold);
+        }
+        else if (key == "batch")
+        {
+            correct = (in >> spec.batch) && spec.batch > 0;
+        }
+        else
+        {
+            correct = false;
+        }
+
+        if (!correct)
+        {
+            std::cout << filename << ":" << line_number << ": uncorrect line \"" << line << "\"" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+unsigned long long count_scenarios(const SweepSpec& spec)
+{
+    unsigned long long count = 1;
+    for (int i = 0; i < NumAxes; ++i)
+        count *= spec.axes[i].size();
+
+    return count;
+}
+
+void get_scenario(const SweepSpec& spec, unsigned long long index, double* values)
+{
+    for (int i = NumAxes - 1; i >= 0; --i)
+    {
+        const unsigned long long size = spec.axes[i].size();
+        values[i] = spec.axes[i][index % size];
+        index /= size;
+    }
+}
+
+unsigned long long hash_sweep_spec(const SweepSpec& spec)
+{
+    // FNV-1a over the expanded spec printed with full precision
+    std::string text;
+    char buffer[64];
+
+    for (int i = 0; i < NumAxes; ++i)
+    {
+        text += axis_names[i];
+        for (double value : spec.axes[i])
+        {
+            std::snprintf(buffer, sizeof(buffer), " %.17g", value);
+            text += buffer;
+        }
+        text += '\n';
+    }
+
+    std::snprintf(buffer, sizeof(buffer), "%.17g %u %d %.17g\n", spec.step, spec.steps, spec.use_double ? 1 : 0, spec.drift_threshold);
+    text += buffer;
+
+    unsigned long long hash = 14695981039346656037ull;
+    for (unsigned char c : text)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Axes of a sweep, in the order of the arrays mass, l, theta and w of main.cpp
+enum SweepAxis
+{
+    Mass1, Length1, Mass2, Length2, Theta1, Omega1, Theta2, Omega2, NumAxes
+};
+
+// Cartesian grid of double pendulum scenarios read from a text file:
+//
+//   # comment
+//   mass1  = 0.6
+//   mass2  = 0.3 0.6 1.2
+//   theta1 = linspace 0.1 3.1 64    (64 values from 0.1 to 3.1)
+//   step   = 0.0041666667
+//   steps  = 14400
+//
+// Axes left out of the file keep a single value: m = 1, l = 1, theta = pi / 2, omega = 0.
+struct SweepSpec
+{
+    std::vector<double> axes[NumAxes];
+
+    double step = 1.0 / 240;
+    unsigned int steps = 2400;
+    bool use_double = true;
+    // Energy drift threshold of the ensemble, <= 0 disables the re-integration of drifting steps
+    double drift_threshold = 0.0;
+    // Scenarios integrated together as one ensemble
+    unsigned int batch = 65536;
+};
+
+const char* get_axis_name(int axis);
+
+bool read_sweep_spec(const char* filename, SweepSpec& spec);
+
+unsigned long long count_scenarios(const SweepSpec& spec);
+// Values of all axes of a scenario, the last axis changes fastest
+void get_scenario(const SweepSpec& spec, unsigned long long index, double* values);
+
+// Hash of everything that affects the results, shards of different specs are never merged
+unsigned long long hash_sweep_spec(const SweepSpec& spec);
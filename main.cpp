@@ -1,16 +1,41 @@
 #include <iostream>
+#include <chrono>
+#include <cstring>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 #include "ShaderClass.h"
+#include "EmbeddedShaders.h"
 #include "VBO.h"
 #include "VAO.h"
 #include "EBO.h"
 
 #include "Pendulum.h"
+#include "PendulumHistory.h"
+#include "TrajectoryCache.h"
+#include "MetricsServer.h"
 
-int main()
+int main(int argc, char** argv)
 {
+    const auto start_time = std::chrono::steady_clock::now();
+    bool first_frame = true;
+
+    // Metrics are always counted, served only with --metrics <port> or --metrics unix:<path>
+    MetricsRegistry metrics;
+    Counter& steps_total = metrics.addCounter("pendulum_steps_total", "Simulation steps integrated.");
+    Gauge& steps_per_second = metrics.addGauge("pendulum_steps_per_second", "Simulation steps integrated during the last second.");
+    Counter& frames_total = metrics.addCounter("pendulum_frames_total", "Frames rendered.");
+    Gauge& frame_time = metrics.addGauge("pendulum_frame_time_seconds", "Time between the last two rendered frames.");
+    Counter& dropped_frames_total = metrics.addCounter("pendulum_dropped_frames_total", "Frames of the 60 Hz schedule not rendered in time.");
+    Gauge& energy_drift = metrics.addGauge("pendulum_energy_drift", "Relative drift of the total energy from the initial energy.");
+
+    MetricsServer metrics_server(metrics);
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--metrics") == 0 && metrics_server.start(argv[i + 1]))
+            std::cout << "Serving metrics at " << argv[i + 1] << " (GET /metrics)" << std::endl;
+    }
+
     // Initialize GLFW
     glfwInit();
 
@@ -38,20 +63,37 @@ int main()
     // Specify the viewport of OpenGL in the window (from x,y to x1,y1)
     glViewport(0, 0, 720, 720);
 
-    // Creates shader object using shaders default.vert and default.frag
-    Shader shader_program("default.vert", "default.frag");
+    // Creates shader object using shaders default.vert and default.frag embedded at build time
+    const auto shader_start = std::chrono::steady_clock::now();
+    Shader shader_program(default_vert, default_frag, "shader_cache.bin");
+    const double shader_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shader_start).count();
 
-    float mass[2] = { 0.6f, 0.6f }, l[2] = { 0.4f, 0.4f }, theta[2] = { M_PI / 2, M_PI / 2 }, w[2] = { 0.0f, 0.0f };
+    float mass[2] = { 0.6f, 0.6f }, l[2] = { 0.4f, 0.4f }, theta[2] = { PendulumConstants<float>::pi / 2, PendulumConstants<float>::pi / 2 }, w[2] = { 0.0f, 0.0f };
     DoublePendulum pendulum(mass, l, theta, w);
     pendulum.calculateDrawVertices();
     pendulum.createBuffers();
 
+    // Keyframe every second, the last 10 minutes can be rewound
+    PendulumHistory<DoublePendulumModel, float> history(pendulum, 1.0f / 60, 60, 600);
+    // Replayed and cached frames cost no integration, only the steps the model actually takes are counted
+    history.setStepCallback([&steps_total]() { steps_total.increment(); });
+
+    // The first minute of the same initial conditions is integrated once and served from the disk on later runs
+    TrajectoryCache trajectory_cache("trajectory_cache");
+    TrajectoryCache::Trajectory trajectory;
+    if (trajectory_cache.getTrajectory(pendulum, 1.0f / 60, 3600, trajectory))
+        history.setPrecomputed(trajectory.frames, trajectory.count);
+    bool paused = false;
+    bool space_pressed = false;
+
     GLuint uColorID = glGetUniformLocation(shader_program.ID, "uColor");
 
     // Tell OpenGL which Shader Program we want to use
     shader_program.Activate();
     double last_time = glfwGetTime();
     double cur_time = last_time;
+    double rate_time = last_time;
+    unsigned long long rate_steps = 0;
 
     while (!glfwWindowShouldClose(window))
     {
@@ -60,21 +102,63 @@ int main()
             continue;
         else
         {
+            const double elapsed = cur_time - last_time;
+            frame_time.set(elapsed);
+            // Intervals of two and more frames mean frames of the schedule were skipped
+            if (elapsed >= 2.0 / 60)
+                dropped_frames_total.increment((unsigned long long)(elapsed * 60) - 1);
+
             last_time = cur_time;
         }
 
         glClearColor(0.8f, 0.8f, 0.8f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        pendulum.calculatePhysicalModel(1.0 / 60);
+        // Space - pause, Left / Right - rewind / forward frame by frame, Page Up / Page Down - by 5 seconds
+        const bool space = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+        if (space && !space_pressed)
+            paused = !paused;
+        space_pressed = space;
+
+        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+            history.seek(history.getFrame() > 0 ? history.getFrame() - 1 : 0);
+        else if (glfwGetKey(window, GLFW_KEY_PAGE_UP) == GLFW_PRESS)
+            history.seek(history.getFrame() > 300 ? history.getFrame() - 300 : 0);
+        else if (glfwGetKey(window, GLFW_KEY_PAGE_DOWN) == GLFW_PRESS)
+            history.seek(history.getFrame() + 300);
+        else if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS || !paused)
+            history.advance();
+
+        energy_drift.set(pendulum.getEnergyDrift());
+        if (cur_time - rate_time >= 1.0)
+        {
+            steps_per_second.set((steps_total.get() - rate_steps) / (cur_time - rate_time));
+            rate_steps = steps_total.get();
+            rate_time = cur_time;
+        }
+
         pendulum.draw(shader_program.ID);
         
          glfwSwapBuffers(window);
+        frames_total.increment();
+
+        if (first_frame)
+        {
+            // Waits for the frame to be really drawn, once
+            glFinish();
+            first_frame = false;
+
+            const double first_frame_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+            std::cout << "Time to first frame: " << first_frame_ms << " ms (shader program "
+                      << (shader_program.isLoadedFromCache() ? "loaded from cache" : "compiled") << " in " << shader_ms << " ms)" << std::endl;
+        }
 
         // All GLFW Events
         glfwPollEvents();
     }
 
+    metrics_server.stop();
+
     pendulum.deleteBuffers();
 
     shader_program.Delete();